@@ -216,7 +216,7 @@ MStatus DDConvexHullNode::processInputIndex(MPointArray &allPoints,
     
     // Create the function set for meshes and query for the points
     MFnMesh curMeshFn(curMesh);
-    MPointArray meshPoints;
+    MPointArray &meshPoints = mMeshPoints;
     curMeshFn.getPoints(meshPoints);
     
     // Assume we have a mesh here.  If the comps are null, then that
@@ -309,8 +309,10 @@ MStatus DDConvexHullNode::compute(const MPlug &plug, MDataBlock &data)
         }
 
 
-        // Get the data from the input compound
-        MPointArray allPoints;
+        // Get the data from the input compound.  clear() keeps the memory
+        // of the last evaluation
+        MPointArray &allPoints = mAllPoints;
+        allPoints.clear();
         MArrayDataHandle inputData(data.inputArrayValue(inputAttr, &stat));
         uint elemCount = inputData.elementCount();
         if (elemCount == 0)
@@ -394,7 +396,8 @@ MStatus DDConvexHullNode::compute(const MPlug &plug, MDataBlock &data)
         // Generate the hull
         stat = DDConvexHullUtils::generateMayaHull(outputMesh,
                                                    allPoints,
-                                                   hullOptions);
+                                                   hullOptions,
+                                                   &mCache);
 
         if (stat != MStatus::kSuccess)
         {
@@ -29,7 +29,7 @@
 #ifndef __DDConvexHull__DDConvexHullNode__
 #define __DDConvexHull__DDConvexHullNode__
 
-#include "StanHull/hull.h"
+#include "DDConvexHullUtils.h"
 #include <maya/MPxNode.h>
 #include <maya/MTypeId.h>
 #include <maya/MFnMesh.h>
@@ -70,6 +70,11 @@ private:
     MStatus processInputIndex(MPointArray &allPoints,
                               MDataHandle &meshHndl,
                               MDataHandle &compHndl);
+
+    // Keep the points and the hull's memory from one evaluation to the next
+    MPointArray mAllPoints;
+    MPointArray mMeshPoints;
+    DDConvexHullUtils::hullCache mCache;
 };
 
 
@@ -48,46 +48,24 @@ MString DDConvexHullUtils::int_to_string(int x)
     return MString((ss.str()).c_str());
 }
 
-MStatus DDConvexHullUtils::generateMayaHull(MObject &output,
-                                const MObject &input,
-                                const DDConvexHullUtils::hullOpts &hullOptions)
+double *DDConvexHullUtils::hullCache::reserveInput(uint numVerts)
 {
-    // Convert the input mobject to mfnmesh
-    if (!input.hasFn(MFn::kMesh))
+    if (numVerts > inputCapacity || !inputVerts)
     {
-        return MStatus::kInvalidParameter;
+        delete[] inputVerts;
+        inputCapacity = numVerts;
+        inputVerts = new double[numVerts ? numVerts*3 : 3];
     }
-    MFnMesh inputMesh(input);
-    
-    // Allocate an array for the vertices and fill it with the data extracted
-    // from the input mesh
-    uint numInputVerts = inputMesh.numVertices();
-    if (!numInputVerts)
-    {
-        return MStatus::kFailure;
-    }
-    
-    MPointArray points;
-    inputMesh.getPoints(points);
-    
-    return generateMayaHull(output, points, hullOptions);
+    return inputVerts;
 }
 
-MStatus DDConvexHullUtils::generateMayaHull(MObject &output,
-                                const MPointArray &vertices,
-                                const DDConvexHullUtils::hullOpts &hullOptions)
+// Builds the hull of the points hullDescription already points at and turns
+// it into a mesh in output
+static MStatus buildMayaHull(MObject &output,
+                             HullDesc &hullDescription,
+                             const DDConvexHullUtils::hullOpts &hullOptions,
+                             DDConvexHullUtils::hullCache &cache)
 {
-    // Allocate and push the vert list into the new array Mem Cleanup req.
-    uint numInputVerts = vertices.length();
-    double *inputVerts = new double[numInputVerts*3];
-    for (uint i=0; i < numInputVerts; i++)
-    {
-        uint offset = i*3;
-        inputVerts[offset]   = vertices[i].x;
-        inputVerts[offset+1] = vertices[i].y;
-        inputVerts[offset+2] = vertices[i].z;
-    }
-    
     // Setup the flags
     uint hullFlags = QF_DEFAULT;
     if (hullOptions.forceTriangles)
@@ -103,25 +81,22 @@ MStatus DDConvexHullUtils::generateMayaHull(MObject &output,
         hullFlags |= QF_REVERSE_ORDER;
     }
     
-    // Create the description
-    HullDesc hullDescription;
+    // Fill in the rest of the description
     hullDescription.mFlags = hullFlags;
     hullDescription.mMaxVertices = hullOptions.maxOutputVertices;
     hullDescription.mSkinWidth = hullOptions.skinWidth;
     hullDescription.mNormalEpsilon = hullOptions.normalEpsilon;
-    hullDescription.mVertexStride = sizeof(double)*3;
-    hullDescription.mVcount = numInputVerts;
-    hullDescription.mVertices = inputVerts;
     
-    // Create the hull
-    HullLibrary hullComputer;
+    // Create the hull. The workspace owns the result, nothing to release
     HullResult hullResult;
-    HullError err = hullComputer.CreateConvexHull(hullDescription, hullResult);
+    HullError err = cache.workspace.CreateConvexHull(hullDescription,
+                                                     hullResult);
     MStatus hullStat = MStatus::kSuccess;
     if (err == QE_OK)
     {
-        // Grab the verts
-        MPointArray outPoints;
+        // Grab the verts.  clear() keeps the memory of the last hull
+        MPointArray &outPoints = cache.outPoints;
+        outPoints.clear();
         for (uint i=0; i < hullResult.mNumOutputVertices; i++)
         {
             uint offset = i*3;
@@ -134,8 +109,10 @@ MStatus DDConvexHullUtils::generateMayaHull(MObject &output,
         // Check if the results are in polygons, or triangles. Depending on
         // which for the result is in, the way the face indices are setup
         // is different.
-        MIntArray polyCounts;
-        MIntArray vertexConnects;
+        MIntArray &polyCounts = cache.polyCounts;
+        MIntArray &vertexConnects = cache.vertexConnects;
+        polyCounts.clear();
+        vertexConnects.clear();
         
         if (hullResult.mPolygons)
         {
@@ -182,13 +159,70 @@ MStatus DDConvexHullUtils::generateMayaHull(MObject &output,
         hullStat = MStatus::kFailure;
     }
     
-    // Mem Cleanup
-    hullComputer.ReleaseResult(hullResult);
-    delete[] inputVerts;
-    
     return hullStat;
 }
 
+MStatus DDConvexHullUtils::generateMayaHull(MObject &output,
+                                const MObject &input,
+                                const DDConvexHullUtils::hullOpts &hullOptions)
+{
+    // Convert the input mobject to mfnmesh
+    if (!input.hasFn(MFn::kMesh))
+    {
+        return MStatus::kInvalidParameter;
+    }
+    MFnMesh inputMesh(input);
+    
+    // The hull reads the mesh's own packed float x,y,z, no copy needed
+    uint numInputVerts = inputMesh.numVertices();
+    if (!numInputVerts)
+    {
+        return MStatus::kFailure;
+    }
+    MStatus stat;
+    const float *rawPoints = inputMesh.getRawPoints(&stat);
+    if (stat != MStatus::kSuccess)
+    {
+        return stat;
+    }
+    
+    HullDesc hullDescription;
+    hullDescription.mVcount = numInputVerts;
+    hullDescription.SetVertices(rawPoints, sizeof(float)*3);
+    DDConvexHullUtils::hullCache cache;
+    return buildMayaHull(output, hullDescription, hullOptions, cache);
+}
+
+MStatus DDConvexHullUtils::generateMayaHull(MObject &output,
+                                const MPointArray &vertices,
+                                const DDConvexHullUtils::hullOpts &hullOptions,
+                                DDConvexHullUtils::hullCache *cache)
+{
+    // Without a cache from the caller, this call's memory goes with it
+    if (!cache)
+    {
+        DDConvexHullUtils::hullCache localCache;
+        return generateMayaHull(output, vertices, hullOptions, &localCache);
+    }
+    
+    // Push the vert list into the cache's packed array
+    uint numInputVerts = vertices.length();
+    double *inputVerts = cache->reserveInput(numInputVerts);
+    for (uint i=0; i < numInputVerts; i++)
+    {
+        uint offset = i*3;
+        inputVerts[offset]   = vertices[i].x;
+        inputVerts[offset+1] = vertices[i].y;
+        inputVerts[offset+2] = vertices[i].z;
+    }
+    
+    HullDesc hullDescription;
+    hullDescription.mVertexStride = sizeof(double)*3;
+    hullDescription.mVcount = numInputVerts;
+    hullDescription.mVertices = inputVerts;
+    return buildMayaHull(output, hullDescription, hullOptions, *cache);
+}
+
 MStatus DDConvexHullUtils::componentToVertexIDs(MIntArray &outIndices,
                                                 const MObject &mesh,
                                                 const MObject &component)
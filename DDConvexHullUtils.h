@@ -29,6 +29,7 @@
 #ifndef __DDConvexHull__DDConvexHullUtils__
 #define __DDConvexHull__DDConvexHullUtils__
 
+#include "StanHull/hull.h"
 #include <maya/MObject.h>
 #include <maya/MPointArray.h>
 #include <maya/MString.h>
@@ -55,9 +56,33 @@ namespace DDConvexHullUtils
         bool reverseTriangleOrder;
     };
     
+    // Everything a hull needs from one call to the next.  A node keeps one
+    // so that re-evaluating it only ever grows these, never reallocates them
+    struct hullCache
+    {
+        hullCache() : inputVerts(NULL), inputCapacity(0) {}
+        ~hullCache() { delete[] inputVerts; }
+        
+        // Returns room for numVerts packed x,y,z doubles
+        double *reserveInput(uint numVerts);
+        
+        HullWorkspace workspace;
+        double *inputVerts;
+        uint inputCapacity;
+        MPointArray outPoints;
+        MIntArray polyCounts;
+        MIntArray vertexConnects;
+        
+    private:
+        hullCache(const hullCache &);
+        hullCache &operator=(const hullCache &);
+    };
+    
+    // With a cache, the hull reuses its memory from the previous call
     MStatus generateMayaHull(MObject &output,
                              const MPointArray &vertices,
-                             const hullOpts &hullOptions);
+                             const hullOpts &hullOptions,
+                             hullCache *cache = NULL);
     
     MStatus generateMayaHull(MObject &output,
                              const MObject &input,
@@ -1,4 +1,4 @@
-#ifndef HUL_H
+#ifndef HULL_H
 
 #define HULL_H
 
@@ -60,10 +60,12 @@
 // Jtilden - on include string.h for memcpy.  Works on mac and windows
 #include <string.h>
 
-class HullResult
+#define HULL_NO_SOURCE 0xFFFFFFFF // mOutputSources entry of a vertex that is not one of the input points
+
+template <class Real> class HullResultT
 {
 public:
-	HullResult(void)
+	HullResultT(void)
 	{
 		mPolygons = true;
 		mNumOutputVertices = 0;
@@ -71,29 +73,47 @@ public:
 		mNumFaces = 0;
 		mNumIndices = 0;
 		mIndices = 0;
+		mPrefilterRatio = 0;
+		mOutputSources = 0;
+		mHullError = 0;
+		mWorkingSet = 0;
+		mTruncated = false;
 	}
 	bool                    mPolygons;                  // true if indices represents polygons, false indices are triangles
 	unsigned int            mNumOutputVertices;         // number of vertices in the output hull
-	double                  *mOutputVertices;            // array of vertices, 3 doubles each x,y,z
+	Real                    *mOutputVertices;            // array of vertices, 3 Reals each x,y,z
 	unsigned int            mNumFaces;                  // the number of faces produced
 	unsigned int            mNumIndices;                // the total number of indices
 	unsigned int           *mIndices;                   // pointer to indices.
+	double                  mPrefilterRatio;            // with QF_PREFILTER, the fraction of the cleaned up points the prefilter threw away.
+	unsigned int           *mOutputSources;             // per output vertex, the index of the input point it is, or HULL_NO_SOURCE.  Feed these back as HullDesc::mHintIndices.
+	double                  mHullError;                 // how far the furthest input point is outside the plane of a hull face (before any skin width).
+	size_t                  mWorkingSet;                // the most memory, in bytes, the build held at once besides the input and this result.
+	bool                    mTruncated;                 // HullDesc::mTimeLimit or mCancel stopped the build: the hull is valid but of the points added so far, mHullError says how far off.
 
 // If triangles, then indices are array indexes into the vertex list.
 // If polygons, indices are in the form (number of points in face) (p1, p2, p3, ..) etc..
 };
 
+typedef HullResultT<double> HullResult;
+typedef HullResultT<float>  HullResultF;
+
 class FHullResult
 {
 public:
-	FHullResult(const HullResult &r)
+	template <class Real> FHullResult(const HullResultT<Real> &r)
 	{
     mPolygons          = r.mPolygons;
     mNumOutputVertices = r.mNumOutputVertices;
     mNumFaces          = r.mNumFaces;
     mNumIndices        = r.mNumIndices;
+    mPrefilterRatio    = r.mPrefilterRatio;
+    mHullError         = r.mHullError;
+    mWorkingSet        = r.mWorkingSet;
+    mTruncated         = r.mTruncated;
     mIndices           = 0;
     mOutputVertices    = 0;
+    mOutputSources     = 0;
     if ( mNumIndices )
     {
       mIndices = new unsigned int[mNumIndices];
@@ -102,7 +122,7 @@ public:
     if ( mNumOutputVertices )
     {
       mOutputVertices = new float[mNumOutputVertices*3];
-      const double *src = r.mOutputVertices;
+      const Real   *src = r.mOutputVertices;
       float        *dst = mOutputVertices;
       for (unsigned int i=0; i<mNumOutputVertices; i++)
       {
@@ -112,12 +132,18 @@ public:
         dst+=3;
         src+=3;
       }
+    }
+    if ( r.mOutputSources )
+    {
+      mOutputSources = new unsigned int[mNumOutputVertices];
+      memcpy(mOutputSources,r.mOutputSources,sizeof(unsigned int)*mNumOutputVertices);
     }
 	}
   ~FHullResult(void)
   {
-    delete mIndices;
-    delete mOutputVertices;
+    delete []mIndices;
+    delete []mOutputVertices;
+    delete []mOutputSources;
   }
 	bool                    mPolygons;                  // true if indices represents polygons, false indices are triangles
 	unsigned int            mNumOutputVertices;         // number of vertices in the output hull
@@ -125,6 +151,11 @@ public:
 	unsigned int            mNumFaces;                  // the number of faces produced
 	unsigned int            mNumIndices;                // the total number of indices
 	unsigned int           *mIndices;                   // pointer to indices.
+	double                  mPrefilterRatio;            // with QF_PREFILTER, the fraction of the cleaned up points the prefilter threw away.
+	unsigned int           *mOutputSources;             // per output vertex, the index of the input point it is, or HULL_NO_SOURCE.
+	double                  mHullError;                 // how far the furthest input point is outside the plane of a hull face (before any skin width).
+	size_t                  mWorkingSet;                // the most memory, in bytes, the build held at once besides the input and the result.
+	bool                    mTruncated;                 // the build was stopped before the hull was finished.
 
 // If triangles, then indices are array indexes into the vertex list.
 // If polygons, indices are in the form (number of points in face) (p1, p2, p3, ..) etc..
@@ -135,9 +166,24 @@ enum HullFlag
 	QF_TRIANGLES         = (1<<0),             // report results as triangles, not polygons.
 	QF_REVERSE_ORDER     = (1<<1),             // reverse order of the triangle indices.
 	QF_SKIN_WIDTH        = (1<<2),             // extrude hull based on this skin width
+	QF_CONFLICT_LISTS    = (1<<3),             // track outside points per face instead of rescanning the whole cloud for each new face.
+	QF_PARALLEL          = (1<<4),             // spread the work of one big hull over all cores, same result as the serial build.
+	QF_PREFILTER         = (1<<5),             // drop points strictly inside the polytope of the 26 k-DOP extremes before building the hull.
+	QF_EXACT_PREDICATES  = (1<<6),             // decide which faces a new vertex sees with exact orientation tests, no epsilon and no repair passes.
+	QF_SPATIAL_ORDER     = (1<<7),             // sort the cleaned up points along a Morton curve first, for inputs whose order is scattered in space.
+	                                           // Ties go by point order, so coplanar or flat input may give another, equally good, hull.
+	QF_LOW_MEMORY        = (1<<8),             // for huge clouds: let go of each step's buffers once it is done and clean packed doubles up in place (see mVertices).
+	QF_SMALL_INPUT       = (1<<9),             // for batches of tiny clouds: hull up to 64 cleaned up points with a stack only engine, larger ones as usual.
+	QF_CORESET           = (1<<10),            // for huge clouds: meet mTolerance/mRelativeTolerance by hulling only the points a one pass grid keeps, the grid getting what the build's own epsilon leaves of it (mHullError adds its bound).
 	QF_DEFAULT           = 0
 };
 
+enum HullVertexFormat
+{
+	QV_DOUBLE,                                 // input positions are doubles
+	QV_FLOAT                                   // input positions are floats
+};
+
 
 class HullDesc
 {
@@ -151,6 +197,18 @@ public:
 		mNormalEpsilon  = 0.001f;
 		mMaxVertices = 4096; // maximum number of points to be considered for a convex hull.
 		mSkinWidth = 0.01f; // default is one centimeter
+		mMaxThreads      = 0;
+		mVertexFormat    = QV_DOUBLE;
+		mComponents[0]   = mComponents[1] = mComponents[2] = 0;
+		mComponentStride = 0;
+		mHintIndices     = 0;
+		mHintCount       = 0;
+		mTolerance       = 0;
+		mRelativeTolerance = 0;
+		mPlanarThickness = 0;
+		mPlanarTolerance = 0.001f;
+		mTimeLimit       = 0;
+		mCancel          = 0;
 	};
 
 	HullDesc(HullFlag flag,
@@ -165,6 +223,43 @@ public:
 		mNormalEpsilon  = 0.001f;
 		mMaxVertices    = 4096;
 		mSkinWidth = 0.01f; // default is one centimeter
+		mMaxThreads      = 0;
+		mVertexFormat    = QV_DOUBLE;
+		mComponents[0]   = mComponents[1] = mComponents[2] = 0;
+		mComponentStride = 0;
+		mHintIndices     = 0;
+		mHintCount       = 0;
+		mTolerance       = 0;
+		mRelativeTolerance = 0;
+		mPlanarThickness = 0;
+		mPlanarTolerance = 0.001f;
+		mTimeLimit       = 0;
+		mCancel          = 0;
+	}
+
+	// Point the hull at float positions, x,y,z every 'stride' bytes, without copying them.
+	void SetVertices(const float *vertices,unsigned int stride)
+	{
+		SetComponents(vertices,vertices+1,vertices+2,stride);
+	}
+
+	// Point the hull at separate x, y and z streams, each advancing 'stride' bytes per vertex.
+	void SetComponents(const float *x,const float *y,const float *z,unsigned int stride=sizeof(float))
+	{
+		mVertexFormat    = QV_FLOAT;
+		mComponents[0]   = x;
+		mComponents[1]   = y;
+		mComponents[2]   = z;
+		mComponentStride = stride;
+	}
+
+	void SetComponents(const double *x,const double *y,const double *z,unsigned int stride=sizeof(double))
+	{
+		mVertexFormat    = QV_DOUBLE;
+		mComponents[0]   = x;
+		mComponents[1]   = y;
+		mComponents[2]   = z;
+		mComponentStride = stride;
 	}
 
 	bool HasHullFlag(HullFlag flag) const
@@ -185,11 +280,31 @@ public:
 
 	unsigned int      mFlags;           // flags to use when generating the convex hull.
 	unsigned int      mVcount;          // number of vertices in the input point cloud
-	double           *mVertices;        // the array of vertices.
+	double           *mVertices;        // the array of vertices.  With QF_LOW_MEMORY, 8 or more of them packed x,y,z and the double
+	                                    // library, the cleaned up points are written over them: the array no longer holds the input.
 	unsigned int      mVertexStride;    // the stride of each vertex, in bytes.
+	unsigned int      mVertexFormat;    // QV_DOUBLE or QV_FLOAT, what mVertices or mComponents point at.
+	const void       *mComponents[3];   // if set, x, y and z are read from here instead of mVertices.  Use SetVertices/SetComponents.
+	unsigned int      mComponentStride; // bytes between consecutive values in each of mComponents.
 	double            mNormalEpsilon;   // the epsilon for removing duplicates.  This is a normalized value, if normalized bit is on.
 	double            mSkinWidth;
 	unsigned int      mMaxVertices;               // maximum number of vertices to be considered for the hull!
+	unsigned int      mMaxThreads;                // with QF_PARALLEL, the most threads to use.  0 means one per core.
+	const unsigned int *mHintIndices;             // optional input points expected on the hull, e.g. last frame's mOutputSources.
+	unsigned int      mHintCount;                 // the hull starts from these and is then checked against the whole cloud.
+	                                              // Hints do not turn on QF_CONFLICT_LISTS, the build with or without them starts from the hints.
+	double            mTolerance;                 // stop adding vertices once no point is further than this outside the hull.  0 means as far as it goes.
+	                                              // With QF_CORESET, no point is further than this from the hull.
+	double            mRelativeTolerance;         // the same as a fraction of the bounding box diagonal, the larger of the two applies.
+	double            mPlanarThickness;           // points that lie in one plane (to within mPlanarTolerance) are hulled in 2D and made a slab this thick,
+	                                              // never thinner than they are.  0 means as thick as they are, or a tenth of their smallest extent
+	                                              // in the plane when they are flat but for rounding.
+	double            mPlanarTolerance;           // how far off one plane points may be, as a fraction of the bounding box diagonal, and still be
+	                                              // hulled in 2D.  The default is what the 3D build can not tell from flat, 0 takes only points
+	                                              // that are flat but for rounding.
+	double            mTimeLimit;                 // seconds the build may take.  Past that it stops adding vertices and returns the hull so far
+	                                              // with mTruncated set.  0 means no limit.
+	const volatile int *mCancel;                  // if set, another thread can make *mCancel non zero to stop the build the same way.
 };
 
 enum HullError
@@ -198,6 +313,13 @@ enum HullError
 	QE_FAIL           // failed.
 };
 
+enum HullPriority
+{
+	QP_LOW,           // CreateConvexHullAsync takes queued hulls highest priority first,
+	QP_NORMAL,        // and in the order they were asked for within a priority.
+	QP_HIGH
+};
+
 // This class is used when converting a convex hull into a triangle mesh.
 class ConvexHullVertex
 {
@@ -215,32 +337,193 @@ public:
 };
 
 
+template <class Real> class HullLibraryT;
 
-class HullLibrary
+// A hull CreateConvexHullAsync is building on the library's own threads.  Each build
+// has its own copy of the HullDesc, but the points (and hints) it points at are read
+// while it runs and must stay put until the hull is ready.
+template <class Real> class HullFutureT
+{
+public:
+	// Called once Wait would no longer block, on the thread that built the hull (or that
+	// cancelled it before it started).  It may read the result but must not destroy the
+	// future or ask it for another hull.
+	typedef void (*Callback)(HullFutureT<Real> &future,void *user);
+
+	HullFutureT(void);
+	~HullFutureT(void);                         // cancels a hull still queued or building, waits for it to stop and releases the result.
+
+	bool      IsReady(void) const;              // Wait would return right away.
+	HullError Wait(void);                       // blocks until the hull is ready, returns what CreateConvexHull would have.
+	HullResultT<Real> & GetResult(void);        // the hull once ready.  The future owns it and releases it when it is asked for another hull
+	                                            // or destroyed, ReleaseResult on this reference lets go of it sooner.  Copies must not be released.
+	void      Cancel(void);                     // drops a queued hull (Wait then gives QE_FAIL), stops one being built like HullDesc::mCancel
+	                                            // would, unless its desc has an mCancel of its own.
+
+private:
+	friend class HullLibraryT<Real>;
+
+	HullFutureT(const HullFutureT &);
+	HullFutureT & operator=(const HullFutureT &);
+
+	void     *mState;
+};
+
+template<> HullFutureT<double>::HullFutureT(void);
+template<> HullFutureT<double>::~HullFutureT(void);
+template<> bool HullFutureT<double>::IsReady(void) const;
+template<> HullError HullFutureT<double>::Wait(void);
+template<> HullResultT<double> & HullFutureT<double>::GetResult(void);
+template<> void HullFutureT<double>::Cancel(void);
+
+template<> HullFutureT<float>::HullFutureT(void);
+template<> HullFutureT<float>::~HullFutureT(void);
+template<> bool HullFutureT<float>::IsReady(void) const;
+template<> HullError HullFutureT<float>::Wait(void);
+template<> HullResultT<float> & HullFutureT<float>::GetResult(void);
+template<> void HullFutureT<float>::Cancel(void);
+
+typedef HullFutureT<double> HullFuture;
+typedef HullFutureT<float>  HullFutureF;
+
+// How many threads CreateConvexHullAsync builds hulls on, 0 for one per core.  Takes
+// effect at once: extra threads leave after the hull they are on.
+void SetHullAsyncThreads(unsigned int threads);
+
+// The hull is computed entirely in 'Real'.  HullLibrary (double) is the default;
+// HullLibraryF runs the whole pipeline in float, which halves the memory traffic
+// and doubles the SIMD width when single precision output is good enough, e.g.
+// for game ready collision hulls.  Only float and double are provided.
+template <class Real> class HullLibraryT
 {
 public:
 
 	HullError CreateConvexHull(const HullDesc       &desc,           // describes the input request
-															HullResult           &result);        // contains the resulst
+															HullResultT<Real>    &result);        // contains the resulst
+
+	// Builds the hull once and hands back results[i] as CreateConvexHull would have with
+	// mMaxVertices set to budgets[i] (0 for no limit), e.g. 16, 32, 64 and 255 vertex LODs.
+	// The vertices are added greedily, tallest first, so every LOD is the state of the same
+	// construction after that many of them.  Release each result with ReleaseResult.
+	// With QF_SKIN_WIDTH every budget is still built separately.
+	HullError CreateConvexHullLODs(const HullDesc &desc,const unsigned int *budgets,unsigned int count,HullResultT<Real> *results);
+
+	// Builds each of the count requests in descs into results[i], as CreateConvexHull would,
+	// spread over the task pool.  The largest point sets are started first and every thread
+	// reuses its scratch memory from one hull to the next.  errors, if given, gets the outcome
+	// of each request; the call returns QE_FAIL if any of them failed.  Release each result
+	// with ReleaseResult.  Requests with QF_SMALL_INPUT that the small engine takes are hulled
+	// four at a time (eight for floats), one per SIMD lane; the hulls are the same either way.
+	HullError CreateConvexHulls(const HullDesc *descs,unsigned int count,HullResultT<Real> *results,HullError *errors=0);
+
+	// Queues the hull desc asks for and returns without waiting for it; future then says
+	// when it is ready and holds the result.  Hulls run side by side on a pool of their
+	// own, each thread reusing its scratch memory while more are queued, so the point
+	// cleanup of one overlaps the expansion of the next.  callback, if given, is called
+	// once the hull is ready.  Returns QE_FAIL if future is still busy with another hull.
+	HullError CreateConvexHullAsync(const HullDesc &desc,HullFutureT<Real> &future,HullPriority priority=QP_NORMAL,
+	                                typename HullFutureT<Real>::Callback callback=0,void *user=0);
 
-	HullError ReleaseResult(HullResult &result); // release memory allocated for this result, we are done with it.
+	HullError ReleaseResult(HullResultT<Real> &result); // release memory allocated for this result, we are done with it.
 
 	// Utility function to convert the output convex hull as a renderable set of triangles. Unfolds the polygons into
 	// individual triangles, compute the vertex normals, and projects some texture co-ordinates.
-	HullError CreateTriangleMesh(HullResult &answer,ConvexHullTriangleInterface *iface);
+	HullError CreateTriangleMesh(HullResultT<Real> &answer,ConvexHullTriangleInterface *iface);
+};
+
+template<> HullError HullLibraryT<double>::CreateConvexHull(const HullDesc &desc,HullResultT<double> &result);
+template<> HullError HullLibraryT<double>::CreateConvexHullLODs(const HullDesc &desc,const unsigned int *budgets,unsigned int count,HullResultT<double> *results);
+template<> HullError HullLibraryT<double>::CreateConvexHulls(const HullDesc *descs,unsigned int count,HullResultT<double> *results,HullError *errors);
+template<> HullError HullLibraryT<double>::CreateConvexHullAsync(const HullDesc &desc,HullFutureT<double> &future,HullPriority priority,HullFutureT<double>::Callback callback,void *user);
+template<> HullError HullLibraryT<double>::ReleaseResult(HullResultT<double> &result);
+template<> HullError HullLibraryT<double>::CreateTriangleMesh(HullResultT<double> &answer,ConvexHullTriangleInterface *iface);
+
+template<> HullError HullLibraryT<float>::CreateConvexHull(const HullDesc &desc,HullResultT<float> &result);
+template<> HullError HullLibraryT<float>::CreateConvexHullLODs(const HullDesc &desc,const unsigned int *budgets,unsigned int count,HullResultT<float> *results);
+template<> HullError HullLibraryT<float>::CreateConvexHulls(const HullDesc *descs,unsigned int count,HullResultT<float> *results,HullError *errors);
+template<> HullError HullLibraryT<float>::CreateConvexHullAsync(const HullDesc &desc,HullFutureT<float> &future,HullPriority priority,HullFutureT<float>::Callback callback,void *user);
+template<> HullError HullLibraryT<float>::ReleaseResult(HullResultT<float> &result);
+template<> HullError HullLibraryT<float>::CreateTriangleMesh(HullResultT<float> &answer,ConvexHullTriangleInterface *iface);
+
+typedef HullLibraryT<double> HullLibrary;
+typedef HullLibraryT<float>  HullLibraryF;
+
+// Keeps a hull alive between calls, for points that arrive in batches.  AddPoints only
+// extrudes the faces the new outside points can see, so a batch costs time in proportion
+// to its size and to the part of the hull it changes, not to everything added before it.
+// Points are used as given: there is no duplicate removal or normalization like in
+// CreateConvexHull, and mMaxVertices and QF_SKIN_WIDTH do not apply.  Until the points
+// span a volume AddPoints only collects them, and GetResult hulls what it has the way
+// CreateConvexHull would, so points that all lie in a plane come back as a slab (see
+// mPlanarThickness).  It fails only when no points have been added.
+template <class Real> class IncrementalHullT
+{
+public:
+	IncrementalHullT(void);
+	~IncrementalHullT(void);
+
+	HullError AddPoints(const HullDesc &batch);    // adds the batch.mVcount points batch describes, in any layout HullDesc supports.
+
+	HullError GetResult(HullResultT<Real> &result,unsigned int flags=QF_DEFAULT); // the hull so far.  flags may be QF_TRIANGLES and QF_REVERSE_ORDER.
+
+	HullError ReleaseResult(HullResultT<Real> &result);
+
+	void      Reset(void);                         // forget every point added so far.
+
 private:
-	double ComputeNormal(double *n,const double *A,const double *B,const double *C);
-	void AddConvexTriangle(ConvexHullTriangleInterface *callback,const double *p1,const double *p2,const double *p3);
-
-	void BringOutYourDead(const double *verts,unsigned int vcount, double *overts,unsigned int &ocount,unsigned int *indices,unsigned indexcount);
-
-	bool    CleanupVertices(unsigned int svcount,
-													const double *svertices,
-													unsigned int stride,
-													unsigned int &vcount,       // output number of vertices
-													double *vertices,                 // location to store the results.
-													double  normalepsilon,
-													double *scale);
+	IncrementalHullT(const IncrementalHullT &);
+	IncrementalHullT & operator=(const IncrementalHullT &);
+
+	void     *mState;
 };
 
+template<> IncrementalHullT<double>::IncrementalHullT(void);
+template<> IncrementalHullT<double>::~IncrementalHullT(void);
+template<> HullError IncrementalHullT<double>::AddPoints(const HullDesc &batch);
+template<> HullError IncrementalHullT<double>::GetResult(HullResultT<double> &result,unsigned int flags);
+template<> HullError IncrementalHullT<double>::ReleaseResult(HullResultT<double> &result);
+template<> void IncrementalHullT<double>::Reset(void);
+
+template<> IncrementalHullT<float>::IncrementalHullT(void);
+template<> IncrementalHullT<float>::~IncrementalHullT(void);
+template<> HullError IncrementalHullT<float>::AddPoints(const HullDesc &batch);
+template<> HullError IncrementalHullT<float>::GetResult(HullResultT<float> &result,unsigned int flags);
+template<> HullError IncrementalHullT<float>::ReleaseResult(HullResultT<float> &result);
+template<> void IncrementalHullT<float>::Reset(void);
+
+typedef IncrementalHullT<double> IncrementalHull;
+typedef IncrementalHullT<float>  IncrementalHullF;
+
+// Keeps the memory of CreateConvexHull between calls, for a hull that is rebuilt over and
+// over, e.g. whenever a node is evaluated.  Every buffer grows to the largest hull seen so
+// far and is then reused, so once warmed up a build makes no heap allocations at all
+// (QF_SKIN_WIDTH and QF_PARALLEL still do).  The result's arrays belong to the workspace:
+// they stay valid until its next CreateConvexHull or its destruction, and the result must
+// not be passed to ReleaseResult.
+template <class Real> class HullWorkspaceT
+{
+public:
+	HullWorkspaceT(void);
+	~HullWorkspaceT(void);
+
+	HullError CreateConvexHull(const HullDesc &desc,HullResultT<Real> &result);
+
+private:
+	HullWorkspaceT(const HullWorkspaceT &);
+	HullWorkspaceT & operator=(const HullWorkspaceT &);
+
+	void     *mState;
+};
+
+template<> HullWorkspaceT<double>::HullWorkspaceT(void);
+template<> HullWorkspaceT<double>::~HullWorkspaceT(void);
+template<> HullError HullWorkspaceT<double>::CreateConvexHull(const HullDesc &desc,HullResultT<double> &result);
+
+template<> HullWorkspaceT<float>::HullWorkspaceT(void);
+template<> HullWorkspaceT<float>::~HullWorkspaceT(void);
+template<> HullError HullWorkspaceT<float>::CreateConvexHull(const HullDesc &desc,HullResultT<float> &result);
+
+typedef HullWorkspaceT<double> HullWorkspace;
+typedef HullWorkspaceT<float>  HullWorkspaceF;
+
 #endif
@@ -0,0 +1,7154 @@
+// hullcore.h : the convex hull implementation, written in terms of 'Real'.
+//
+// This file has no include guard on purpose.  hull.cpp includes it twice, with
+// HULL_REAL set to double and then to float, and HULL_NAMESPACE naming the
+// namespace each copy is built in.  HULL_REAL_FLOAT is 1 for the float build
+// so the few precision specific pieces (tolerances, SIMD kernels) can differ.
+
+#ifndef HULL_REAL
+#error hullcore.h is only meant to be included by hull.cpp
+#endif
+
+namespace HULL_NAMESPACE
+{
+
+typedef HULL_REAL Real;
+
+//****************************************************
+//** VECMATH.H
+//****************************************************
+#ifndef PLUGIN_3DSMAX
+#define PI (3.1415926535897932384626433832795f)
+#endif
+
+#define DEG2RAD (PI / 180.0f)
+#define RAD2DEG (180.0f / PI)
+#define SQRT_OF_2 (1.4142135f)
+#define OFFSET(Class,Member)  (((char*) (&(((Class*)NULL)-> Member )))- ((char*)NULL))
+
+
+
+int    argmin(Real a[],int n);
+Real  sqr(Real a); 
+Real  clampf(Real a) ;
+Real  Round(Real a,Real precision);
+Real  Interpolate(const Real &f0,const Real &f1,Real alpha) ;
+
+template <class T>
+void Swap(T &a,T &b) 
+{
+	T tmp = a;
+	a=b;
+	b=tmp;
+}
+
+
+
+template <class T>
+T Max(const T &a,const T &b) 
+{
+	return (a>b)?a:b;
+}
+
+template <class T>
+T Min(const T &a,const T &b) 
+{
+	return (a<b)?a:b;
+}
+
+//----------------------------------
+
+class int3  
+{
+public:
+	int x,y,z;
+	int3(){};
+	int3(int _x,int _y, int _z){x=_x;y=_y;z=_z;}
+	const int& operator[](int i) const {return (&x)[i];}
+	int& operator[](int i) {return (&x)[i];}
+};
+
+
+//-------- 2D --------
+
+class real2
+{
+public:
+	Real x,y;
+	real2(){x=0;y=0;};
+	real2(Real _x,Real _y){x=_x;y=_y;}
+	Real& operator[](int i) {assert(i>=0&&i<2);return ((Real*)this)[i];}
+	const Real& operator[](int i) const {assert(i>=0&&i<2);return ((Real*)this)[i];}
+};
+inline real2 operator-( const real2& a, const real2& b ){return real2(a.x-b.x,a.y-b.y);}
+inline real2 operator+( const real2& a, const real2& b ){return real2(a.x+b.x,a.y+b.y);}
+
+//--------- 3D ---------
+
+class real3 // 3D
+{
+	public:
+	Real x,y,z;
+	real3(){x=0;y=0;z=0;};
+	real3(Real _x,Real _y,Real _z){x=_x;y=_y;z=_z;};
+	//operator Real *() { return &x;};
+	Real& operator[](int i) {assert(i>=0&&i<3);return ((Real*)this)[i];}
+	const Real& operator[](int i) const {assert(i>=0&&i<3);return ((Real*)this)[i];}
+#	ifdef PLUGIN_3DSMAX
+	real3(const Point3 &p):x(p.x),y(p.y),z(p.z){}
+	operator Point3(){return *((Point3*)this);}
+#	endif
+};
+
+
+real3& operator+=( real3 &a, const real3& b );
+real3& operator-=( real3 &a ,const real3& b );
+real3& operator*=( real3 &v ,const Real s );
+real3& operator/=( real3 &v, const Real s );
+
+Real  magnitude( const real3& v );
+real3 normalize( const real3& v );
+real3 safenormalize(const real3 &v);
+real3 vabs(const real3 &v);
+real3 operator+( const real3& a, const real3& b );
+real3 operator-( const real3& a, const real3& b );
+real3 operator-( const real3& v );
+real3 operator*( const real3& v, const Real s );
+real3 operator*( const Real s, const real3& v );
+real3 operator/( const real3& v, const Real s );
+inline int operator==( const real3 &a, const real3 &b ) { return (a.x==b.x && a.y==b.y && a.z==b.z); }
+inline int operator!=( const real3 &a, const real3 &b ) { return (a.x!=b.x || a.y!=b.y || a.z!=b.z); }
+// due to ambiguity and inconsistent standards ther are no overloaded operators for mult such as va*vb.
+Real  dot( const real3& a, const real3& b );
+real3 cmul( const real3 &a, const real3 &b);
+real3 cross( const real3& a, const real3& b );
+real3 Interpolate(const real3 &v0,const real3 &v1,Real alpha);
+real3 Round(const real3& a,Real precision);
+real3	VectorMax(const real3 &a, const real3 &b);
+real3	VectorMin(const real3 &a, const real3 &b);
+
+
+
+class real3x3
+{
+	public:
+	real3 x,y,z;  // the 3 rows of the Matrix
+	real3x3(){}
+	real3x3(Real xx,Real xy,Real xz,Real yx,Real yy,Real yz,Real zx,Real zy,Real zz):x(xx,xy,xz),y(yx,yy,yz),z(zx,zy,zz){}
+	real3x3(real3 _x,real3 _y,real3 _z):x(_x),y(_y),z(_z){}
+	real3&       operator[](int i)       {assert(i>=0&&i<3);return (&x)[i];}
+	const real3& operator[](int i) const {assert(i>=0&&i<3);return (&x)[i];}
+	Real&        operator()(int r, int c)       {assert(r>=0&&r<3&&c>=0&&c<3);return ((&x)[r])[c];}
+	const Real&  operator()(int r, int c) const {assert(r>=0&&r<3&&c>=0&&c<3);return ((&x)[r])[c];}
+}; 
+real3x3 Transpose( const real3x3& m );
+real3   operator*( const real3& v  , const real3x3& m  );
+real3   operator*( const real3x3& m , const real3& v   );
+real3x3 operator*( const real3x3& m , const Real& s   );
+real3x3 operator*( const real3x3& ma, const real3x3& mb );
+real3x3 operator/( const real3x3& a, const Real& s ) ;
+real3x3 operator+( const real3x3& a, const real3x3& b );
+real3x3 operator-( const real3x3& a, const real3x3& b );
+real3x3 &operator+=( real3x3& a, const real3x3& b );
+real3x3 &operator-=( real3x3& a, const real3x3& b );
+real3x3 &operator*=( real3x3& a, const Real& s );
+Real    Determinant(const real3x3& m );
+real3x3 Inverse(const real3x3& a);  // its just 3x3 so we simply do that cofactor method
+
+
+//-------- 4D Math --------
+
+class real4
+{
+public:
+	Real x,y,z,w;
+	real4(){x=0;y=0;z=0;w=0;};
+	real4(Real _x,Real _y,Real _z,Real _w){x=_x;y=_y;z=_z;w=_w;}
+	real4(const real3 &v,Real _w){x=v.x;y=v.y;z=v.z;w=_w;}
+	//operator Real *() { return &x;};
+	Real& operator[](int i) {assert(i>=0&&i<4);return ((Real*)this)[i];}
+	const Real& operator[](int i) const {assert(i>=0&&i<4);return ((Real*)this)[i];}
+	const real3& xyz() const { return *((real3*)this);}
+	real3&       xyz()       { return *((real3*)this);}
+};
+
+
+struct D3DXMATRIX; 
+
+class real4x4
+{
+	public:
+	real4 x,y,z,w;  // the 4 rows
+	real4x4(){}
+	real4x4(const real4 &_x, const real4 &_y, const real4 &_z, const real4 &_w):x(_x),y(_y),z(_z),w(_w){}
+	real4x4(Real m00, Real m01, Real m02, Real m03, 
+						Real m10, Real m11, Real m12, Real m13, 
+				Real m20, Real m21, Real m22, Real m23, 
+				Real m30, Real m31, Real m32, Real m33 )
+			:x(m00,m01,m02,m03),y(m10,m11,m12,m13),z(m20,m21,m22,m23),w(m30,m31,m32,m33){}
+	Real&       operator()(int r, int c)       {assert(r>=0&&r<4&&c>=0&&c<4);return ((&x)[r])[c];}
+	const Real& operator()(int r, int c) const {assert(r>=0&&r<4&&c>=0&&c<4);return ((&x)[r])[c];}
+		operator       Real* ()       {return &x.x;}
+		operator const Real* () const {return &x.x;}
+	operator       struct D3DXMATRIX* ()       { return (struct D3DXMATRIX*) this;}
+	operator const struct D3DXMATRIX* () const { return (struct D3DXMATRIX*) this;}
+};
+
+
+int     operator==( const real4 &a, const real4 &b );
+real4 Homogenize(const real3 &v3,const Real &w=1.0f); // Turns a 3D real3 4D vector4 by appending w
+real4 cmul( const real4 &a, const real4 &b);
+real4 operator*( const real4 &v, Real s);
+real4 operator*( Real s, const real4 &v);
+real4 operator+( const real4 &a, const real4 &b);
+real4 operator-( const real4 &a, const real4 &b);
+real4x4 operator*( const real4x4& a, const real4x4& b );
+real4 operator*( const real4& v, const real4x4& m );
+real4x4 Inverse(const real4x4 &m);
+real4x4 MatrixRigidInverse(const real4x4 &m);
+real4x4 MatrixTranspose(const real4x4 &m);
+real4x4 MatrixPerspectiveFov(Real fovy, Real Aspect, Real zn, Real zf );
+real4x4 MatrixTranslation(const real3 &t);
+real4x4 MatrixRotationZ(const Real angle_radians);
+real4x4 MatrixLookAt(const real3& eye, const real3& at, const real3& up);
+int     operator==( const real4x4 &a, const real4x4 &b );
+
+
+//-------- Quaternion ------------
+
+class Quaternion :public real4
+{
+ public:
+	Quaternion() { x = y = z = 0.0f; w = 1.0f; }
+	Quaternion( real3 v, Real t ) { v = normalize(v); w = cos(t/2.0f); v = v*sin(t/2.0f); x = v.x; y = v.y; z = v.z; }
+	Quaternion(Real _x, Real _y, Real _z, Real _w){x=_x;y=_y;z=_z;w=_w;}
+	Real angle() const { return acos(w)*2.0f; }
+	real3 axis() const { real3 a(x,y,z); if(fabs(angle())<0.0000001f) return real3(1,0,0); return a*(1/sin(angle()/2.0f)); }
+	real3 xdir() const { return real3( 1-2*(y*y+z*z),  2*(x*y+w*z),  2*(x*z-w*y) ); }
+	real3 ydir() const { return real3(   2*(x*y-w*z),1-2*(x*x+z*z),  2*(y*z+w*x) ); }
+	real3 zdir() const { return real3(   2*(x*z+w*y),  2*(y*z-w*x),1-2*(x*x+y*y) ); }
+	real3x3 getmatrix() const { return real3x3( xdir(), ydir(), zdir() ); }
+	operator real3x3() { return getmatrix(); }
+	void Normalize();
+};
+
+Quaternion& operator*=(Quaternion& a, Real s );
+Quaternion	operator*( const Quaternion& a, Real s );
+Quaternion	operator*( const Quaternion& a, const Quaternion& b);
+Quaternion	operator+( const Quaternion& a, const Quaternion& b );
+Quaternion	normalize( Quaternion a );
+Real		dot( const Quaternion &a, const Quaternion &b );
+real3		operator*( const Quaternion& q, const real3& v );
+real3		operator*( const real3& v, const Quaternion& q );
+Quaternion	slerp( Quaternion a, const Quaternion& b, Real interp );
+Quaternion  Interpolate(const Quaternion &q0,const Quaternion &q1,Real alpha); 
+Quaternion  RotationArc(real3 v0, real3 v1 );  // returns quat q where q*v0=v1
+Quaternion  Inverse(const Quaternion &q);
+real4x4     MatrixFromQuatVec(const Quaternion &q, const real3 &v);
+
+
+//------ Euler Angle -----
+
+Quaternion YawPitchRoll( Real yaw, Real pitch, Real roll );
+Real Yaw( const Quaternion& q );
+Real Pitch( const Quaternion& q );
+Real Roll( Quaternion q );
+Real Yaw( const real3& v );
+Real Pitch( const real3& v );
+
+
+//------- Plane ----------
+
+class Plane 
+{
+	public:
+	real3	normal;
+	Real	dist;   // distance below origin - the D from plane equasion Ax+By+Cz+D=0
+			Plane(const real3 &n,Real d):normal(n),dist(d){}
+			Plane():normal(),dist(0){}
+	void	Transform(const real3 &position, const Quaternion &orientation);
+};
+
+inline Plane PlaneFlip(const Plane &plane){return Plane(-plane.normal,-plane.dist);}
+inline int operator==( const Plane &a, const Plane &b ) { return (a.normal==b.normal && a.dist==b.dist); }
+inline int coplanar( const Plane &a, const Plane &b ) { return (a==b || a==PlaneFlip(b)); }
+
+
+//--------- Utility Functions ------
+
+real3  PlaneLineIntersection(const Plane &plane, const real3 &p0, const real3 &p1);
+real3  PlaneProject(const Plane &plane, const real3 &point);
+real3  LineProject(const real3 &p0, const real3 &p1, const real3 &a);  // projects a onto infinite line p0p1
+Real   LineProjectTime(const real3 &p0, const real3 &p1, const real3 &a);
+real3  ThreePlaneIntersection(const Plane &p0,const Plane &p1, const Plane &p2);
+int     PolyHit(const real3 *vert,const int n,const real3 &v0, const real3 &v1, real3 *impact=NULL, real3 *normal=NULL);
+int     BoxInside(const real3 &p,const real3 &bmin, const real3 &bmax) ;
+int     BoxIntersect(const real3 &v0, const real3 &v1, const real3 &bmin, const real3 &bmax, real3 *impact);
+Real   DistanceBetweenLines(const real3 &ustart, const real3 &udir, const real3 &vstart, const real3 &vdir, real3 *upoint=NULL, real3 *vpoint=NULL);
+real3  TriNormal(const real3 &v0, const real3 &v1, const real3 &v2);
+real3  NormalOf(const real3 *vert, const int n);
+Quaternion VirtualTrackBall(const real3 &cop, const real3 &cor, const real3 &dir0, const real3 &dir1);
+
+
+
+
+//*****************************************************
+// ** VECMATH.CPP
+//*****************************************************
+
+
+Real   sqr(Real a) {return a*a;}
+Real   clampf(Real a) {return Min((Real)1,Max((Real)0,a));}
+
+
+Real Round(Real a,Real precision)
+{
+	return floor(0.5f+a/precision)*precision;
+}
+
+
+Real Interpolate(const Real &f0,const Real &f1,Real alpha) 
+{
+	return f0*(1-alpha) + f1*alpha;
+}
+
+
+int     argmin(Real a[],int n)
+{
+	int r=0;
+	for(int i=1;i<n;i++) 
+		{
+		if(a[i]<a[r]) 
+				{
+			r = i;			
+		}
+	}
+	return r;
+}
+
+
+
+//------------ real3 (3D) --------------
+
+
+
+real3 operator+( const real3& a, const real3& b ) 
+{
+	return real3(a.x+b.x, a.y+b.y, a.z+b.z); 
+}
+
+
+real3 operator-( const real3& a, const real3& b )
+{
+	return real3( a.x-b.x, a.y-b.y, a.z-b.z ); 
+}
+
+
+real3 operator-( const real3& v )                     
+{
+	return real3( -v.x, -v.y, -v.z ); 
+}
+
+
+real3 operator*( const real3& v, Real s )      
+{
+	return real3( v.x*s, v.y*s, v.z*s ); 
+}
+
+
+real3 operator*( Real s, const real3& v )      
+{
+	return real3( v.x*s, v.y*s, v.z*s ); 
+}
+
+
+real3 operator/( const real3& v, Real s )
+{ 
+	return v*(1.0f/s); 
+}
+
+Real  dot( const real3& a, const real3& b )    
+{
+	return a.x*b.x + a.y*b.y + a.z*b.z; 
+}
+
+real3 cmul( const real3 &v1, const real3 &v2) 
+{ 
+	return real3(v1.x*v2.x, v1.y*v2.y, v1.z*v2.z); 
+}
+
+
+real3 cross( const real3& a, const real3& b )
+{
+		return real3( a.y*b.z - a.z*b.y,
+									 a.z*b.x - a.x*b.z,
+									 a.x*b.y - a.y*b.x );
+}
+
+
+
+
+real3& operator+=( real3& a , const real3& b )
+{
+		a.x += b.x;
+		a.y += b.y;
+		a.z += b.z;
+		return a;
+}
+
+
+real3& operator-=( real3& a , const real3& b )
+{
+		a.x -= b.x;
+		a.y -= b.y;
+		a.z -= b.z;
+		return a;
+}
+
+
+real3& operator*=(real3& v , Real s )
+{
+		v.x *= s;
+		v.y *= s;
+		v.z *= s;
+		return v;
+}
+
+
+real3& operator/=(real3& v , Real s )
+{
+		Real sinv = 1.0f / s;
+		v.x *= sinv;
+		v.y *= sinv;
+		v.z *= sinv;
+		return v;
+}
+
+real3 vabs(const real3 &v)
+{
+	return real3(fabs(v.x),fabs(v.y),fabs(v.z));
+}
+
+
+Real magnitude( const real3& v )
+{
+		return sqrt(sqr(v.x) + sqr( v.y)+ sqr(v.z));
+}
+
+
+
+real3 normalize( const real3 &v )
+{
+	// this routine, normalize, is ok, provided magnitude works!!
+		Real d=magnitude(v);
+		if (d==0) 
+		{
+		printf("Cant normalize ZERO vector\n");
+		assert(0);// yes this could go here
+		d=0.1f;
+	}
+	d = 1/d;
+	return real3(v.x*d,v.y*d,v.z*d);
+}
+
+real3 safenormalize(const real3 &v)
+{
+	if(magnitude(v)<=0.0f)
+	{
+		return real3(1,0,0);
+	}
+	return normalize(v);
+}
+
+real3 Round(const real3 &a,Real precision)
+{
+	return real3(Round(a.x,precision),Round(a.y,precision),Round(a.z,precision));
+}
+
+
+real3 Interpolate(const real3 &v0,const real3 &v1,Real alpha) 
+{
+	return v0*(1-alpha) + v1*alpha;
+}
+
+real3 VectorMin(const real3 &a,const real3 &b)
+{
+	return real3(Min(a.x,b.x),Min(a.y,b.y),Min(a.z,b.z));
+}
+real3 VectorMax(const real3 &a,const real3 &b)
+{
+	return real3(Max(a.x,b.x),Max(a.y,b.y),Max(a.z,b.z));
+}
+
+// the statement v1*v2 is ambiguous since there are 3 types
+// of vector multiplication
+//  - componantwise (for example combining colors)
+//  - dot product
+//  - cross product
+// Therefore we never declare/implement this function.
+// So we will never see:  real3 operator*(real3 a,real3 b) 
+
+
+
+
+//------------ real3x3 ---------------
+Real Determinant(const real3x3 &m)
+{
+	return  m.x.x*m.y.y*m.z.z + m.y.x*m.z.y*m.x.z + m.z.x*m.x.y*m.y.z 
+			 -m.x.x*m.z.y*m.y.z - m.y.x*m.x.y*m.z.z - m.z.x*m.y.y*m.x.z ;
+}
+
+real3x3 Inverse(const real3x3 &a)
+{
+	real3x3 b;
+	Real d=Determinant(a);
+	assert(d!=0);
+	for(int i=0;i<3;i++) 
+		{
+		for(int j=0;j<3;j++) 
+				{
+			int i1=(i+1)%3;
+			int i2=(i+2)%3;
+			int j1=(j+1)%3;
+			int j2=(j+2)%3;
+			// reverse indexs i&j to take transpose
+			b[j][i] = (a[i1][j1]*a[i2][j2]-a[i1][j2]*a[i2][j1])/d;
+		}
+	}
+	// Matrix check=a*b; // Matrix 'check' should be the identity (or close to it)
+	return b;
+}
+
+
+real3x3 Transpose( const real3x3& m )
+{
+	return real3x3( real3(m.x.x,m.y.x,m.z.x),
+					real3(m.x.y,m.y.y,m.z.y),
+					real3(m.x.z,m.y.z,m.z.z));
+}
+
+
+real3 operator*(const real3& v , const real3x3 &m ) { 
+	return real3((m.x.x*v.x + m.y.x*v.y + m.z.x*v.z), 
+					(m.x.y*v.x + m.y.y*v.y + m.z.y*v.z), 
+					(m.x.z*v.x + m.y.z*v.y + m.z.z*v.z));
+}
+real3 operator*(const real3x3 &m,const real3& v  ) { 
+	return real3(dot(m.x,v),dot(m.y,v),dot(m.z,v));
+}
+
+
+real3x3 operator*( const real3x3& a, const real3x3& b )  
+{ 
+	return real3x3(a.x*b,a.y*b,a.z*b);
+}
+
+real3x3 operator*( const real3x3& a, const Real& s )  
+{ 
+	return real3x3(a.x*s, a.y*s ,a.z*s); 
+}
+real3x3 operator/( const real3x3& a, const Real& s )  
+{ 
+	Real t=1/s;
+	return real3x3(a.x*t, a.y*t ,a.z*t); 
+}
+real3x3 operator+( const real3x3& a, const real3x3& b )
+{
+	return real3x3(a.x+b.x, a.y+b.y, a.z+b.z);
+}
+real3x3 operator-( const real3x3& a, const real3x3& b )
+{
+	return real3x3(a.x-b.x, a.y-b.y, a.z-b.z);
+}
+real3x3 &operator+=( real3x3& a, const real3x3& b )
+{
+	a.x+=b.x;
+	a.y+=b.y;
+	a.z+=b.z;
+	return a;
+}
+real3x3 &operator-=( real3x3& a, const real3x3& b )
+{
+	a.x-=b.x;
+	a.y-=b.y;
+	a.z-=b.z;
+	return a;
+}
+real3x3 &operator*=( real3x3& a, const Real& s )
+{
+	a.x*=s;
+	a.y*=s;
+	a.z*=s;
+	return a;
+}
+
+
+
+real3 ThreePlaneIntersection(const Plane &p0,const Plane &p1, const Plane &p2){
+	real3x3 mp =Transpose(real3x3(p0.normal,p1.normal,p2.normal));
+	real3x3 mi = Inverse(mp);
+	real3 b(p0.dist,p1.dist,p2.dist);
+	return -b * mi;
+}
+
+
+//--------------- 4D ----------------
+
+real4   operator*( const real4&   v, const real4x4& m )
+{
+	return v.x*m.x + v.y*m.y + v.z*m.z + v.w*m.w; // yes this actually works
+}
+
+int operator==( const real4 &a, const real4 &b ) 
+{
+	return (a.x==b.x && a.y==b.y && a.z==b.z && a.w==b.w); 
+}
+
+
+//  Dont implement m*v for now, since that might confuse us
+//  All our transforms are based on multiplying the "row" vector on the left
+//real4   operator*(const real4x4& m , const real4&   v )
+//{
+//	return real4(dot(v,m.x),dot(v,m.y),dot(v,m.z),dot(v,m.w));
+//}
+
+
+
+real4 cmul( const real4 &a, const real4 &b) 
+{
+	return real4(a.x*b.x,a.y*b.y,a.z*b.z,a.w*b.w);
+}
+
+
+real4 operator*( const real4 &v, Real s) 
+{
+	return real4(v.x*s,v.y*s,v.z*s,v.w*s);
+}
+
+
+real4 operator*( Real s, const real4 &v) 
+{
+	return real4(v.x*s,v.y*s,v.z*s,v.w*s);
+}
+
+
+real4 operator+( const real4 &a, const real4 &b) 
+{
+	return real4(a.x+b.x,a.y+b.y,a.z+b.z,a.w+b.w);
+}
+
+
+
+real4 operator-( const real4 &a, const real4 &b) 
+{
+	return real4(a.x-b.x,a.y-b.y,a.z-b.z,a.w-b.w);
+}
+
+
+real4 Homogenize(const real3 &v3,const Real &w)
+{
+	return real4(v3.x,v3.y,v3.z,w);
+}
+
+
+
+real4x4 operator*( const real4x4& a, const real4x4& b )
+{
+	return real4x4(a.x*b,a.y*b,a.z*b,a.w*b);
+}
+
+real4x4 MatrixTranspose(const real4x4 &m)
+{
+	return real4x4(
+		m.x.x, m.y.x, m.z.x, m.w.x,
+		m.x.y, m.y.y, m.z.y, m.w.y,
+		m.x.z, m.y.z, m.z.z, m.w.z,
+		m.x.w, m.y.w, m.z.w, m.w.w );
+}
+
+real4x4 MatrixRigidInverse(const real4x4 &m)
+{
+	real4x4 trans_inverse = MatrixTranslation(-m.w.xyz());
+	real4x4 rot   = m;
+	rot.w = real4(0,0,0,1);
+	return trans_inverse * MatrixTranspose(rot);
+}
+
+
+real4x4 MatrixPerspectiveFov(Real fovy, Real aspect, Real zn, Real zf )
+{
+	Real h = 1.0f/tan(fovy/2.0f); // view space height
+	Real w = h / aspect ;  // view space width
+	return real4x4(
+		w, 0, 0             ,   0,
+		0, h, 0             ,   0,
+		0, 0, zf/(zn-zf)    ,  -1,
+		0, 0, zn*zf/(zn-zf) ,   0 );
+}
+
+
+
+real4x4 MatrixLookAt(const real3& eye, const real3& at, const real3& up)
+{
+	real4x4 m;
+	m.w.w = 1.0f;
+	m.w.xyz() = eye;
+	m.z.xyz() = normalize(eye-at);
+	m.x.xyz() = normalize(cross(up,m.z.xyz()));
+	m.y.xyz() = cross(m.z.xyz(),m.x.xyz());
+	return MatrixRigidInverse(m);
+}
+
+
+real4x4 MatrixTranslation(const real3 &t)
+{
+	return real4x4(
+		1,  0,  0,  0,
+		0,  1,  0,  0,
+		0,  0,  1,  0,
+		t.x,t.y,t.z,1 );
+}
+
+
+real4x4 MatrixRotationZ(const Real angle_radians)
+{
+	Real s =  sin(angle_radians);
+	Real c =  cos(angle_radians);
+	return real4x4(
+		c,  s,  0,  0,
+		-s, c,  0,  0,
+		0,  0,  1,  0,
+		0,  0,  0,  1 );
+}
+
+
+
+int operator==( const real4x4 &a, const real4x4 &b )
+{
+	return (a.x==b.x && a.y==b.y && a.z==b.z && a.w==b.w);
+}
+
+
+real4x4 Inverse(const real4x4 &m)
+{
+	real4x4 d;
+	Real *dst = &d.x.x;
+	Real tmp[12]; /* temp array for pairs */
+	Real src[16]; /* array of transpose source matrix */
+	Real det; /* determinant */
+	/* transpose matrix */
+	for ( int i = 0; i < 4; i++) {
+		src[i] = m(i,0) ;
+		src[i + 4] = m(i,1);
+		src[i + 8] = m(i,2);
+		src[i + 12] = m(i,3); 
+	}
+	/* calculate pairs for first 8 elements (cofactors) */
+	tmp[0]  = src[10] * src[15];
+	tmp[1]  = src[11] * src[14];
+	tmp[2]  = src[9] * src[15];
+	tmp[3]  = src[11] * src[13];
+	tmp[4]  = src[9] * src[14];
+	tmp[5]  = src[10] * src[13];
+	tmp[6]  = src[8] * src[15];
+	tmp[7]  = src[11] * src[12];
+	tmp[8]  = src[8] * src[14];
+	tmp[9]  = src[10] * src[12];
+	tmp[10] = src[8] * src[13];
+	tmp[11] = src[9] * src[12];
+	/* calculate first 8 elements (cofactors) */
+	dst[0]  = tmp[0]*src[5] + tmp[3]*src[6] + tmp[4]*src[7];
+	dst[0] -= tmp[1]*src[5] + tmp[2]*src[6] + tmp[5]*src[7];
+	dst[1]  = tmp[1]*src[4] + tmp[6]*src[6] + tmp[9]*src[7];
+	dst[1] -= tmp[0]*src[4] + tmp[7]*src[6] + tmp[8]*src[7];
+	dst[2]  = tmp[2]*src[4] + tmp[7]*src[5] + tmp[10]*src[7];
+	dst[2] -= tmp[3]*src[4] + tmp[6]*src[5] + tmp[11]*src[7];
+	dst[3]  = tmp[5]*src[4] + tmp[8]*src[5] + tmp[11]*src[6];
+	dst[3] -= tmp[4]*src[4] + tmp[9]*src[5] + tmp[10]*src[6];
+	dst[4]  = tmp[1]*src[1] + tmp[2]*src[2] + tmp[5]*src[3];
+	dst[4] -= tmp[0]*src[1] + tmp[3]*src[2] + tmp[4]*src[3];
+	dst[5]  = tmp[0]*src[0] + tmp[7]*src[2] + tmp[8]*src[3];
+	dst[5] -= tmp[1]*src[0] + tmp[6]*src[2] + tmp[9]*src[3];
+	dst[6]  = tmp[3]*src[0] + tmp[6]*src[1] + tmp[11]*src[3];
+	dst[6] -= tmp[2]*src[0] + tmp[7]*src[1] + tmp[10]*src[3];
+	dst[7]  = tmp[4]*src[0] + tmp[9]*src[1] + tmp[10]*src[2];
+	dst[7] -= tmp[5]*src[0] + tmp[8]*src[1] + tmp[11]*src[2];
+	/* calculate pairs for second 8 elements (cofactors) */
+	tmp[0]  = src[2]*src[7];
+	tmp[1]  = src[3]*src[6];
+	tmp[2]  = src[1]*src[7];
+	tmp[3]  = src[3]*src[5];
+	tmp[4]  = src[1]*src[6];
+	tmp[5]  = src[2]*src[5];
+	tmp[6]  = src[0]*src[7];
+	tmp[7]  = src[3]*src[4];
+	tmp[8]  = src[0]*src[6];
+	tmp[9]  = src[2]*src[4];
+	tmp[10] = src[0]*src[5];
+	tmp[11] = src[1]*src[4];
+	/* calculate second 8 elements (cofactors) */
+	dst[8]  = tmp[0]*src[13] + tmp[3]*src[14] + tmp[4]*src[15];
+	dst[8] -= tmp[1]*src[13] + tmp[2]*src[14] + tmp[5]*src[15];
+	dst[9]  = tmp[1]*src[12] + tmp[6]*src[14] + tmp[9]*src[15];
+	dst[9] -= tmp[0]*src[12] + tmp[7]*src[14] + tmp[8]*src[15];
+	dst[10] = tmp[2]*src[12] + tmp[7]*src[13] + tmp[10]*src[15];
+	dst[10]-= tmp[3]*src[12] + tmp[6]*src[13] + tmp[11]*src[15];
+	dst[11] = tmp[5]*src[12] + tmp[8]*src[13] + tmp[11]*src[14];
+	dst[11]-= tmp[4]*src[12] + tmp[9]*src[13] + tmp[10]*src[14];
+	dst[12] = tmp[2]*src[10] + tmp[5]*src[11] + tmp[1]*src[9];
+	dst[12]-= tmp[4]*src[11] + tmp[0]*src[9] + tmp[3]*src[10];
+	dst[13] = tmp[8]*src[11] + tmp[0]*src[8] + tmp[7]*src[10];
+	dst[13]-= tmp[6]*src[10] + tmp[9]*src[11] + tmp[1]*src[8];
+	dst[14] = tmp[6]*src[9] + tmp[11]*src[11] + tmp[3]*src[8];
+	dst[14]-= tmp[10]*src[11] + tmp[2]*src[8] + tmp[7]*src[9];
+	dst[15] = tmp[10]*src[10] + tmp[4]*src[8] + tmp[9]*src[9];
+	dst[15]-= tmp[8]*src[9] + tmp[11]*src[10] + tmp[5]*src[8];
+	/* calculate determinant */
+	det=src[0]*dst[0]+src[1]*dst[1]+src[2]*dst[2]+src[3]*dst[3];
+	/* calculate matrix inverse */
+	det = 1/det;
+	for ( int j = 0; j < 16; j++)
+	dst[j] *= det;
+	return d;
+}
+
+
+//--------- Quaternion --------------
+	
+Quaternion operator*( const Quaternion& a, const Quaternion& b )
+{
+	Quaternion c;
+	c.w = a.w*b.w - a.x*b.x - a.y*b.y - a.z*b.z; 
+	c.x = a.w*b.x + a.x*b.w + a.y*b.z - a.z*b.y; 
+	c.y = a.w*b.y - a.x*b.z + a.y*b.w + a.z*b.x; 
+	c.z = a.w*b.z + a.x*b.y - a.y*b.x + a.z*b.w; 
+	return c;
+}
+
+
+Quaternion operator*( const Quaternion& a, Real b )
+{
+	return Quaternion(a.x*b, a.y*b, a.z*b ,a.w*b);
+}
+
+Quaternion  Inverse(const Quaternion &q)
+{
+	return Quaternion(-q.x,-q.y,-q.z,q.w);
+}
+
+Quaternion& operator*=( Quaternion& q, const Real s )
+{
+		q.x *= s;
+		q.y *= s;
+		q.z *= s;
+		q.w *= s;
+		return q;
+}
+void Quaternion::Normalize()
+{
+	Real m = sqrt(sqr(w)+sqr(x)+sqr(y)+sqr(z));
+	if(m<0.000000001f) {
+		w=1.0f;
+		x=y=z=0.0f;
+		return;
+	}
+	(*this) *= (1.0f/m);
+}
+
+real3 operator*( const Quaternion& q, const real3& v )
+{
+	// The following is equivalent to:   
+	//return (q.getmatrix() * v);  
+	Real qx2 = q.x*q.x;
+	Real qy2 = q.y*q.y;
+	Real qz2 = q.z*q.z;
+
+	Real qxqy = q.x*q.y;
+	Real qxqz = q.x*q.z;
+	Real qxqw = q.x*q.w;
+	Real qyqz = q.y*q.z;
+	Real qyqw = q.y*q.w;
+	Real qzqw = q.z*q.w;
+	return real3(
+		(1-2*(qy2+qz2))*v.x + (2*(qxqy-qzqw))*v.y + (2*(qxqz+qyqw))*v.z ,
+		(2*(qxqy+qzqw))*v.x + (1-2*(qx2+qz2))*v.y + (2*(qyqz-qxqw))*v.z ,
+		(2*(qxqz-qyqw))*v.x + (2*(qyqz+qxqw))*v.y + (1-2*(qx2+qy2))*v.z  );
+}
+
+real3 operator*( const real3& v, const Quaternion& q )
+{
+	assert(0);  // must multiply with the quat on the left
+	return real3(0.0f,0.0f,0.0f);
+}
+
+Quaternion operator+( const Quaternion& a, const Quaternion& b )
+{
+	return Quaternion(a.x+b.x, a.y+b.y, a.z+b.z, a.w+b.w);
+}
+
+Real dot( const Quaternion &a,const Quaternion &b )
+{
+	return  (a.w*b.w + a.x*b.x + a.y*b.y + a.z*b.z); 
+}
+
+Quaternion normalize( Quaternion a )
+{
+	Real m = sqrt(sqr(a.w)+sqr(a.x)+sqr(a.y)+sqr(a.z));
+	if(m<0.000000001) 
+		{    
+		a.w=1;
+		a.x=a.y=a.z=0;
+		return a;
+	}
+	return a * (1/m);
+}
+
+Quaternion slerp( Quaternion a, const Quaternion& b, Real interp )
+{
+	if(dot(a,b) <0.0) 
+		{
+		a.w=-a.w;
+		a.x=-a.x;
+		a.y=-a.y;
+		a.z=-a.z;
+	}
+	Real d = dot(a,b);
+	if(d>=1.0) {
+		return a;
+	}
+	Real theta = acos(d);
+	if(theta==0.0f) { return(a);}
+	return a*(sin(theta-interp*theta)/sin(theta)) + b*(sin(interp*theta)/sin(theta));
+}
+
+
+Quaternion Interpolate(const Quaternion &q0,const Quaternion &q1,Real alpha) {
+	return slerp(q0,q1,alpha);
+}
+
+
+Quaternion YawPitchRoll( Real yaw, Real pitch, Real roll ) 
+{
+	roll  *= DEG2RAD;
+	yaw   *= DEG2RAD;
+	pitch *= DEG2RAD;
+	return Quaternion(real3(0.0f,0.0f,1.0f),yaw)*Quaternion(real3(1.0f,0.0f,0.0f),pitch)*Quaternion(real3(0.0f,1.0f,0.0f),roll);
+}
+
+Real Yaw( const Quaternion& q )
+{
+	static real3 v;
+	v=q.ydir();
+	return (v.y==0.0&&v.x==0.0) ? 0.0: atan2(-v.x,v.y)*RAD2DEG;
+}
+
+Real Pitch( const Quaternion& q )
+{
+	static real3 v;
+	v=q.ydir();
+	return atan2(v.z,sqrt(sqr(v.x)+sqr(v.y)))*RAD2DEG;
+}
+
+Real Roll( Quaternion q )
+{
+	q = Quaternion(real3(0.0f,0.0f,1.0f),-Yaw(q)*DEG2RAD)  *q;
+	q = Quaternion(real3(1.0f,0.0f,0.0f),-Pitch(q)*DEG2RAD)  *q;
+	return atan2(-q.xdir().z,q.xdir().x)*RAD2DEG;
+}
+
+Real Yaw( const real3& v )
+{
+	return (v.y==0.0&&v.x==0.0) ? 0.0f: atan2(-v.x,v.y)*RAD2DEG;
+}
+
+Real Pitch( const real3& v )
+{
+	return atan2(v.z,sqrt(sqr(v.x)+sqr(v.y)))*RAD2DEG;
+}
+
+
+//------------- Plane --------------
+
+
+void Plane::Transform(const real3 &position, const Quaternion &orientation) {
+	//   Transforms the plane to the space defined by the 
+	//   given position/orientation.
+	static real3 newnormal;
+	static real3 origin;
+
+	newnormal = Inverse(orientation)*normal;
+	origin = Inverse(orientation)*(-normal*dist - position);
+
+	normal = newnormal;
+	dist = -dot(newnormal, origin);
+}
+
+
+
+
+//--------- utility functions -------------
+
+//        RotationArc()
+// Given two vectors v0 and v1 this function
+// returns quaternion q where q*v0==v1.
+// Routine taken from game programming gems.
+Quaternion RotationArc(real3 v0,real3 v1){
+	static Quaternion q;
+	v0 = normalize(v0);  // Comment these two lines out if you know its not needed.
+	v1 = normalize(v1);  // If vector is already unit length then why do it again?
+	real3  c = cross(v0,v1);
+	Real   d = dot(v0,v1);
+	if(d<=-1.0f) { return Quaternion(1,0,0,0);} // 180 about x axis
+	Real   s = sqrt((1+d)*2);
+	q.x = c.x / s;
+	q.y = c.y / s;
+	q.z = c.z / s;
+	q.w = s /2.0f;
+	return q;
+}
+
+
+real4x4 MatrixFromQuatVec(const Quaternion &q, const real3 &v) 
+{
+	// builds a 4x4 transformation matrix based on orientation q and translation v 
+	Real qx2 = q.x*q.x;
+	Real qy2 = q.y*q.y;
+	Real qz2 = q.z*q.z;
+
+	Real qxqy = q.x*q.y;
+	Real qxqz = q.x*q.z;
+	Real qxqw = q.x*q.w;
+	Real qyqz = q.y*q.z;
+	Real qyqw = q.y*q.w;
+	Real qzqw = q.z*q.w;
+
+	return real4x4(
+		1-2*(qy2+qz2),  
+		2*(qxqy+qzqw),  
+		2*(qxqz-qyqw),  
+		0            ,  
+		2*(qxqy-qzqw),  
+		1-2*(qx2+qz2),  
+		2*(qyqz+qxqw),  
+		0            ,  
+		2*(qxqz+qyqw),  
+		2*(qyqz-qxqw),  
+		1-2*(qx2+qy2),  
+		0    , 
+		 v.x ,
+		 v.y ,
+		 v.z ,
+		 1.0f );
+}
+
+
+real3 PlaneLineIntersection(const Plane &plane, const real3 &p0, const real3 &p1)
+{
+	// returns the point where the line p0-p1 intersects the plane n&d
+				static real3 dif;
+		dif = p1-p0;
+				Real dn= dot(plane.normal,dif);
+				Real t = -(plane.dist+dot(plane.normal,p0) )/dn;
+				return p0 + (dif*t);
+}
+
+real3 PlaneProject(const Plane &plane, const real3 &point)
+{
+	return point - plane.normal * (dot(point,plane.normal)+plane.dist);
+}
+
+real3 LineProject(const real3 &p0, const real3 &p1, const real3 &a)
+{
+	real3 w;
+	w = p1-p0;
+	Real t= dot(w,(a-p0)) / (sqr(w.x)+sqr(w.y)+sqr(w.z));
+	return p0+ w*t;
+}
+
+
+Real LineProjectTime(const real3 &p0, const real3 &p1, const real3 &a)
+{
+	real3 w;
+	w = p1-p0;
+	Real t= dot(w,(a-p0)) / (sqr(w.x)+sqr(w.y)+sqr(w.z));
+	return t;
+}
+
+
+
+real3 TriNormal(const real3 &v0, const real3 &v1, const real3 &v2)
+{
+	// return the normal of the triangle
+	// inscribed by v0, v1, and v2
+	real3 cp=cross(v1-v0,v2-v1);
+	Real m=magnitude(cp);
+	if(m==0) return real3(1,0,0);
+	return cp*(1.0f/m);
+}
+
+
+
+int BoxInside(const real3 &p, const real3 &bmin, const real3 &bmax) 
+{
+	return (p.x >= bmin.x && p.x <=bmax.x && 
+			p.y >= bmin.y && p.y <=bmax.y && 
+			p.z >= bmin.z && p.z <=bmax.z );
+}
+
+
+int BoxIntersect(const real3 &v0, const real3 &v1, const real3 &bmin, const real3 &bmax,real3 *impact)
+{
+	if(BoxInside(v0,bmin,bmax))
+		{
+				*impact=v0;
+				return 1;
+		}
+	if(v0.x<=bmin.x && v1.x>=bmin.x) 
+		{
+		Real a = (bmin.x-v0.x)/(v1.x-v0.x);
+		//v.x = bmin.x;
+		Real vy =  (1-a) *v0.y + a*v1.y;
+		Real vz =  (1-a) *v0.z + a*v1.z;
+		if(vy>=bmin.y && vy<=bmax.y && vz>=bmin.z && vz<=bmax.z) 
+				{
+			impact->x = bmin.x;
+			impact->y = vy;
+			impact->z = vz;
+			return 1;
+		}
+	}
+	else if(v0.x >= bmax.x  &&  v1.x <= bmax.x) 
+		{
+		Real a = (bmax.x-v0.x)/(v1.x-v0.x);
+		//v.x = bmax.x;
+		Real vy =  (1-a) *v0.y + a*v1.y;
+		Real vz =  (1-a) *v0.z + a*v1.z;
+		if(vy>=bmin.y && vy<=bmax.y && vz>=bmin.z && vz<=bmax.z) 
+				{
+			impact->x = bmax.x;
+			impact->y = vy;
+			impact->z = vz;
+			return 1;
+		}
+	}
+	if(v0.y<=bmin.y && v1.y>=bmin.y) 
+		{
+		Real a = (bmin.y-v0.y)/(v1.y-v0.y);
+		Real vx =  (1-a) *v0.x + a*v1.x;
+		//v.y = bmin.y;
+		Real vz =  (1-a) *v0.z + a*v1.z;
+		if(vx>=bmin.x && vx<=bmax.x && vz>=bmin.z && vz<=bmax.z) 
+				{
+			impact->x = vx;
+			impact->y = bmin.y;
+			impact->z = vz;
+			return 1;
+		}
+	}
+	else if(v0.y >= bmax.y  &&  v1.y <= bmax.y) 
+		{
+		Real a = (bmax.y-v0.y)/(v1.y-v0.y);
+		Real vx =  (1-a) *v0.x + a*v1.x;
+		// vy = bmax.y;
+		Real vz =  (1-a) *v0.z + a*v1.z;
+		if(vx>=bmin.x && vx<=bmax.x && vz>=bmin.z && vz<=bmax.z) 
+				{
+			impact->x = vx;
+			impact->y = bmax.y;
+			impact->z = vz;
+			return 1;
+		}
+	}
+	if(v0.z<=bmin.z && v1.z>=bmin.z) 
+		{
+		Real a = (bmin.z-v0.z)/(v1.z-v0.z);
+		Real vx =  (1-a) *v0.x + a*v1.x;
+		Real vy =  (1-a) *v0.y + a*v1.y;
+		// v.z = bmin.z;
+		if(vy>=bmin.y && vy<=bmax.y && vx>=bmin.x && vx<=bmax.x) 
+				{
+			impact->x = vx;
+			impact->y = vy;
+			impact->z = bmin.z;
+			return 1;
+		}
+	}
+	else if(v0.z >= bmax.z  &&  v1.z <= bmax.z) 
+		{
+		Real a = (bmax.z-v0.z)/(v1.z-v0.z);
+		Real vx =  (1-a) *v0.x + a*v1.x;
+		Real vy =  (1-a) *v0.y + a*v1.y;
+		// v.z = bmax.z;
+		if(vy>=bmin.y && vy<=bmax.y && vx>=bmin.x && vx<=bmax.x) 
+				{
+			impact->x = vx;
+			impact->y = vy;
+			impact->z = bmax.z;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+
+Real DistanceBetweenLines(const real3 &ustart, const real3 &udir, const real3 &vstart, const real3 &vdir, real3 *upoint, real3 *vpoint)
+{
+	static real3 cp;
+	cp = normalize(cross(udir,vdir));
+
+	Real distu = -dot(cp,ustart);
+	Real distv = -dot(cp,vstart);
+	Real dist = (Real)fabs(distu-distv);
+	if(upoint) 
+		{
+		Plane plane;
+		plane.normal = normalize(cross(vdir,cp));
+		plane.dist = -dot(plane.normal,vstart);
+		*upoint = PlaneLineIntersection(plane,ustart,ustart+udir);
+	}
+	if(vpoint) 
+		{
+		Plane plane;
+		plane.normal = normalize(cross(udir,cp));
+		plane.dist = -dot(plane.normal,ustart);
+		*vpoint = PlaneLineIntersection(plane,vstart,vstart+vdir);
+	}
+	return dist;
+}
+
+
+Quaternion VirtualTrackBall(const real3 &cop, const real3 &cor, const real3 &dir1, const real3 &dir2) 
+{
+	// routine taken from game programming gems.
+	// Implement track ball functionality to spin stuf on the screen
+	//  cop   center of projection
+	//  cor   center of rotation
+	//  dir1  old mouse direction 
+	//  dir2  new mouse direction
+	// pretend there is a sphere around cor.  Then find the points
+	// where dir1 and dir2 intersect that sphere.  Find the
+	// rotation that takes the first point to the second.
+	Real m;
+	// compute plane 
+	real3 nrml = cor - cop;
+	Real fudgefactor = 1.0f/(magnitude(nrml) * 0.25f); // since trackball proportional to distance from cop
+	nrml = normalize(nrml);
+	Real dist = -dot(nrml,cor);
+	real3 u= PlaneLineIntersection(Plane(nrml,dist),cop,cop+dir1);
+	u=u-cor;
+	u=u*fudgefactor;
+	m= magnitude(u);
+	if(m>1) 
+		{
+				u/=m;
+		}
+	else 
+		{
+		u=u - (nrml * sqrt(1-m*m));
+	}
+	real3 v= PlaneLineIntersection(Plane(nrml,dist),cop,cop+dir2);
+	v=v-cor;
+	v=v*fudgefactor;
+	m= magnitude(v);
+	if(m>1) 
+		{
+				v/=m;
+		}
+	else 
+		{
+		v=v - (nrml * sqrt(1-m*m));
+	}
+	return RotationArc(u,v);
+}
+
+
+int countpolyhit=0;
+int PolyHit(const real3 *vert, const int n, const real3 &v0, const real3 &v1, real3 *impact, real3 *normal)
+{
+	countpolyhit++;
+	int i;
+	real3 nrml(0,0,0);
+	for(i=0;i<n;i++) 
+		{
+		int i1=(i+1)%n;
+		int i2=(i+2)%n;
+		nrml = nrml + cross(vert[i1]-vert[i],vert[i2]-vert[i1]);
+	}
+
+	Real m = magnitude(nrml);
+	if(m==0.0)
+		{
+				return 0;
+		}
+	nrml = nrml * (1.0f/m);
+	Real dist = -dot(nrml,vert[0]);
+	Real d0,d1;
+	if((d0=dot(v0,nrml)+dist) <0  ||  (d1=dot(v1,nrml)+dist) >0) 
+		{        
+				return 0;
+		}
+
+	static real3 the_point; 
+	// By using the cached plane distances d0 and d1
+	// we can optimize the following:
+	//     the_point = planelineintersection(nrml,dist,v0,v1);
+	Real a = d0/(d0-d1);
+	the_point = v0*(1-a) + v1*a;
+
+
+	int inside=1;
+	for(int j=0;inside && j<n;j++) 
+		{
+			// let inside = 0 if outside
+			real3 pp1,pp2,side;
+			pp1 = vert[j] ;
+			pp2 = vert[(j+1)%n];
+			side = cross((pp2-pp1),(the_point-pp1));
+			inside = (dot(nrml,side) >= 0.0);
+	}
+	if(inside) 
+		{
+		if(normal){*normal=nrml;}
+		if(impact){*impact=the_point;}
+	}
+	return inside;
+}
+
+//****************************************************
+// HULL.H source code goes here
+//****************************************************
+class PHullResult
+{
+public:
+
+	PHullResult(void)
+	{
+		mVcount = 0;
+		mIndexCount = 0;
+		mFaceCount = 0;
+		mVertices = 0;
+		mIndices  = 0;
+	}
+
+	unsigned int mVcount;
+	unsigned int mIndexCount;
+	unsigned int mFaceCount;
+	Real       *mVertices;
+	unsigned int *mIndices;
+};
+
+class HullContext;
+class HullScratch;
+
+bool ComputeHull(HullContext &hc,unsigned int vcount,const Real *vertices,PHullResult &result,unsigned int maxverts,Real inflate);
+void ReleaseHull(PHullResult &result);
+
+// What used to be the private members of HullLibrary.
+static Real ComputeNormal(Real *n,const Real *A,const Real *B,const Real *C);
+static void AddConvexTriangle(ConvexHullTriangleInterface *callback,const Real *p1,const Real *p2,const Real *p3);
+static void BringOutYourDead(const Real *verts,unsigned int vcount, Real *overts,unsigned int &ocount,unsigned int *indices,unsigned indexcount,unsigned int *oindex,Array<unsigned int> &used);
+class HullBounds;
+static bool CleanupVertices(const HullDesc &desc,const HullBounds &bounds,unsigned int &vcount,Real *vertices,unsigned int *sources,Real normalepsilon,Real *scale,Array<int> &weldheads,Array<int> &weldnext,bool lean,const unsigned int *subset,unsigned int subsetcount);
+static unsigned int PlanarPrism(const HullDesc &desc,const HullBounds &bounds,HullScratch &scratch);
+static void PrismHull(HullScratch &scratch,const HullDesc &desc,Real *vsource,const unsigned int *sources,unsigned int vcount,HullResultT<Real> &result);
+static HullError ReleaseResult(HullResultT<Real> &result);
+
+//*****************************************************
+// HULL.cpp source code goes here
+//*****************************************************
+
+
+#define REAL3 real3
+#define REAL  Real
+
+#define COPLANAR   (0)
+#define UNDER      (1)
+#define OVER       (2)
+#define SPLIT      (OVER|UNDER)
+#define PAPERWIDTH (0.001f)
+#if HULL_REAL_FLOAT
+#define VOLUME_EPSILON (1e-12f)  // float triple products of unit sized points carry ~1e-7 of noise
+#else
+#define VOLUME_EPSILON (1e-20f)
+#endif
+
+class Tri;
+
+#define TRIPOOL_BLOCK 1024  // triangles per slab in the TriPool
+
+// Slab allocator for the triangles of a hull.  Triangles are stored by value in
+// fixed size blocks that never move, deleted ones are recycled through a free list,
+// and the whole lot is thrown away in one go with Reset() once the hull is built.
+// Hull construction does no per-triangle malloc/free at all.
+class TriPool
+{
+public:
+	TriPool(void) { used = 0; }
+	~TriPool(void);
+
+	Tri *Alloc(void);
+	void Free(Tri *t) { freelist.Add(t); }
+	void Reset(void)  { used = 0; freelist.count = 0; }
+	size_t WorkingSet(void) const;
+
+	Array<Tri*> blocks;    // each one holds TRIPOOL_BLOCK triangles
+	int         used;      // number of slots handed out so far, across all blocks
+	Array<Tri*> freelist;  // slots given back with Free()
+};
+
+// An entry in the lazy-deletion max-heap that extrudable uses to find the next
+// triangle to extrude.  Entries whose triangle has since been deleted are
+// simply discarded when they reach the top.
+class TriRise
+{
+public:
+	Real rise;
+	int    id;
+};
+
+// One bit per point, for flags that are only ever set and tested.  Resize keeps the bits
+// there are and clears the new ones.
+class HullBits
+{
+public:
+	HullBits(void) { count = 0; }
+
+	bool operator[](int i) const { assert(i>=0 && i<count); return ((bits.element[i>>5]>>(i&31))&1) != 0; }
+	void Set(int i)              { assert(i>=0 && i<count); bits.element[i>>5] |= 1u<<(i&31); }
+	void Clear(void)             { count = 0; bits.count = 0; }
+	void Release(void)           { count = 0; bits.SetSize(0); }
+	void Resize(int n)
+	{
+		int words = (n+31)>>5;
+		int old   = bits.count;
+		bits.Resize(words);
+		for (int i=old; i<words; i++) bits[i] = 0;
+		count = n;
+	}
+
+	Array<unsigned int> bits;
+	int                 count;
+};
+
+// All of the state used while building a single hull.  This used to live in
+// globals, which made the library unusable from more than one thread at a time.
+// One of these is created per CreateConvexHull call and threaded through.
+class HullContext
+{
+public:
+	HullContext(void)
+	{
+		Reset();
+	}
+
+	// Back to the state of a new context, for the next hull.  The arrays and the
+	// triangle slabs keep their memory, so a context that builds one hull after
+	// another stops allocating once it has seen the largest of them.
+	void Reset(void)
+	{
+		planetestepsilon = PAPERWIDTH;
+		minadjangle      = 3.0f;
+		conflictlists    = false;
+		exact            = false;
+		threads          = 1;
+		hullverts        = 0;
+		tolerance        = 0;
+		relativetolerance= 0;
+		stoprise         = 0;
+		error            = 0;
+		timed            = false;
+		cancel           = NULL;
+		truncated        = false;
+		tripool.Reset();
+		tris.count         = 0;
+		riseheap.count     = 0;
+		conflictnext.count = 0;
+		orphans.count      = 0;
+		visible.count      = 0;
+		hints.count        = 0;
+		lodbudgets.count   = 0;
+		lodstart.count     = 0;
+		lodcount.count     = 0;
+		lodtris.count      = 0;
+		loderror.count     = 0;
+		pending.count      = 0;
+		owner.count        = 0;
+		ownerrise.count    = 0;
+		isextreme.Clear();
+		allow.count        = 0;
+		targets.count      = 0;
+		normals.count      = 0;
+		edges.count        = 0;
+		hullindices.count  = 0;
+		cells.count        = 0;
+		cellpoints.count   = 0;
+		cellbounds.count   = 0;
+	}
+
+	// Bytes held by the arrays and the triangle slabs right now.
+	size_t WorkingSet(void) const;
+
+	// Whether the build has run past its deadline or been cancelled.  Once it has, this
+	// keeps saying so and the hull is truncated.
+	bool Expired(void)
+	{
+		if ( !truncated && ((cancel && *cancel) || (timed && std::chrono::steady_clock::now() >= deadline)) ) truncated = true;
+		return truncated;
+	}
+
+	TriPool     tripool;           // storage for the triangles
+	Array<Tri*> tris;              // live triangles of the hull being expanded, NULL where deleted.
+	Array<TriRise> riseheap;       // max-heap on rise of the triangles that have a candidate vertex.
+
+	bool        conflictlists;     // each triangle keeps its own list of outside points (QF_CONFLICT_LISTS)
+	bool        exact;             // which triangles a new vertex sees is decided exactly (QF_EXACT_PREDICATES)
+	Array<int>  conflictnext;      // per input vertex, the next vertex in the same conflict list or -1.
+	Array<int>  orphans;           // heads of the conflict lists of triangles deleted during this step.
+	Array<Tri*> visible;           // scratch for the triangles visible from the vertex being added.
+	Array<int>  hints;             // vertices expected on the hull (HullDesc::mHintIndices), the build starts from these.
+	int         hullverts;         // vertices on the hull being expanded so far.
+	Real        tolerance;         // HullDesc::mTolerance, stop once no point is further than this outside
+	Real        relativetolerance; // HullDesc::mRelativeTolerance, the same as a fraction of the bounding box diagonal
+	Real        stoprise;          // the larger of the two for the hull being built, in its units
+	Real        error;             // hullerror() of the last hull calchullgen finished.
+	bool        timed;             // the build has a deadline (HullDesc::mTimeLimit)
+	std::chrono::steady_clock::time_point deadline; // ... and it is this.
+	const volatile int *cancel;    // HullDesc::mCancel
+	bool        truncated;         // the deadline passed or cancel was set, expansion stopped where it was.
+	Array<int>  lodbudgets;        // vertex counts to keep a copy of the hull at (CreateConvexHullLODs), 0 for the finished one.
+	Array<int>  lodstart;          // ... where each copy starts in lodtris, -1 until it has been taken.
+	Array<int>  lodcount;          // ... and how many indices it has.
+	Array<int>  lodtris;           // the copies, three vertex indices per triangle.
+	Array<Real> loderror;          // ... and hullerror() for each when it was taken.
+	real3       center;            // a point strictly inside the hull, from the first simplex.
+	int         threads;           // how many threads of the HullTaskPool one hull may use (QF_PARALLEL), 1 is serial.
+	Array<int>  pending;           // scratch for the orphans being handed out, in list order.
+	Array<int>  owner;             // ... and the triangle each of them went to, or -1.
+	Array<Real> ownerrise;         // ... and how far above that triangle it is.
+	HullBits    isextreme;         // per input vertex, whether it is a hull vertex (calchullgen).
+	Array<int>  allow;             // ... and whether it may still become one.
+	Array<Tri*> targets;           // scratch for the triangles assignconflicts hands points out to.
+	Array<real3> normals;          // ... their normals, or per triangle id in locateconflicts
+	Array<real3> edges;            // ... which also keeps the planes through center and each edge.
+	Array<int>  hullindices;       // calchull's answer, three vertex indices per triangle, until the next build.
+	Array<int>  cells;             // hullerror: where each cell of the grid over the points starts in cellpoints, empty until built.
+	Array<real3> cellpoints;       // ... the points, cell by cell
+	Array<real3> cellbounds;       // ... and the center and half size of each cell's box
+	Real      planetestepsilon;  // thickness of a plane when classifying vertices in PlaneTest
+	Real      minadjangle;       // in degrees  - result wont have two adjacent facets within this angle of each other.
+};
+
+// A point of a flat input in its plane (PlanarPrism), and which input point it is.
+class PlanarPoint
+{
+public:
+	real2        p;
+	unsigned int source;
+};
+
+// All the memory a build works in, beyond the context: the cleaned up copy of the input
+// points and the buffers of every step after it.  Each one only grows, so a scratch that
+// is used for one hull after another (CreateConvexHulls keeps one per thread, a
+// HullWorkspace one per caller) stops allocating once it has seen the largest of them.
+class HullScratch
+{
+public:
+	HullScratch(void) { ownresults = false; }
+
+	// Bytes held right now by this and both contexts, the build's working set beyond the
+	// input and the results.
+	size_t WorkingSet(void) const;
+
+	HullContext          hc;
+	HullContext          corners;     // prefilter hulls the k-DOP extremes with this one
+	Array<Real>          vsource;     // the points the hull is built from, x,y,z
+	Array<unsigned int>  sources;     // ... and the input index of each
+	Array<int>           where;       // per input point, its place in vsource (hints)
+	Array<int>           weldheads;   // CleanupVertices: the first vertex kept in each hash bucket
+	Array<int>           weldnext;    // ... and the next one in the same bucket
+	Array<PlanarPoint>   planar;      // PlanarPrism: the points in the plane
+	Array<PlanarPoint>   outline;     // ... and their 2D hull
+	Array<int>           extreme;     // prefilter: the k-DOP extremes
+	Array<real3>         extremes;    // ... where they are
+	Array<Plane>         planes;      // ... the planes of their hull
+	Array<char>          keep;        // ... and per point whether it survives
+	Array<Real>          vscratch;    // FinishHull: the vertices the hull uses
+	Array<unsigned int>  oindex;      // ... and where each of them is in vsource
+	Array<unsigned int>  used;        // BringOutYourDead's remapping
+	Array<unsigned int>  morton;      // SpatialOrder: the Morton codes and the sorted order, twice over
+	Array<int>           column;      // Coreset: the lowest and highest point of each column
+	Array<Real>          height;      // ... and how high they are
+	HullBits             corekept;    // ... per input point, whether it is one of them
+	Array<unsigned int>  coreset;     // ... and the input index of each, ascending
+	bool                 ownresults;  // results point into the arrays below instead of NX_ALLOC'd memory
+	Array<Real>          outvertices;
+	Array<unsigned int>  outindices;
+	Array<unsigned int>  outsources;
+};
+
+#if STANDALONE
+class ConvexH 
+#else
+class ConvexH : public NxFoundation::NxAllocateable
+#endif
+{
+  public:
+	class HalfEdge
+	{
+	  public:
+		short ea;         // the other half of the edge (index into edges list)
+		unsigned char v;  // the vertex at the start of this edge (index into vertices list)
+		unsigned char p;  // the facet on which this edge lies (index into facets list)
+		HalfEdge(){}
+		HalfEdge(short _ea,unsigned char _v, unsigned char _p):ea(_ea),v(_v),p(_p){}
+	};
+	Array<REAL3> vertices;
+	Array<HalfEdge> edges;
+	Array<Plane>  facets;
+	ConvexH(int vertices_size,int edges_size,int facets_size);
+};
+
+typedef ConvexH::HalfEdge HalfEdge;
+
+ConvexH::ConvexH(int vertices_size,int edges_size,int facets_size)
+	:vertices(vertices_size)
+	,edges(edges_size)
+	,facets(facets_size)
+{
+	vertices.count=vertices_size;
+	edges.count   = edges_size;
+	facets.count  = facets_size;
+}
+
+ConvexH *ConvexHDup(ConvexH *src)
+{
+#if STANDALONE
+	ConvexH *dst = new ConvexH(src->vertices.count,src->edges.count,src->facets.count);
+#else
+	ConvexH *dst = NX_NEW_MEM(ConvexH(src->vertices.count,src->edges.count,src->facets.count), CONVEX_TEMP);
+#endif
+
+	memcpy(dst->vertices.element,src->vertices.element,sizeof(real3)*src->vertices.count);
+	memcpy(dst->edges.element,src->edges.element,sizeof(HalfEdge)*src->edges.count);
+	memcpy(dst->facets.element,src->facets.element,sizeof(Plane)*src->facets.count);
+	return dst;
+}
+
+
+int PlaneTest(HullContext &hc,const Plane &p, const REAL3 &v) {
+	REAL a  = dot(v,p.normal)+p.dist;
+	int   flag = (a>hc.planetestepsilon)?OVER:((a<-hc.planetestepsilon)?UNDER:COPLANAR);
+	return flag;
+}
+
+int SplitTest(HullContext &hc,ConvexH &convex,const Plane &plane) {
+	int flag=0;
+	for(int i=0;i<convex.vertices.count;i++) {
+		flag |= PlaneTest(hc,plane,convex.vertices[i]);
+	}
+	return flag;
+}
+
+class VertFlag 
+{
+public:
+	unsigned char planetest;
+	unsigned char junk;
+	unsigned char undermap;
+	unsigned char overmap;
+};
+class EdgeFlag 
+{
+public:
+	unsigned char planetest;
+	unsigned char fixes;
+	short undermap;
+	short overmap;
+};
+class PlaneFlag 
+{
+public:
+	unsigned char undermap;
+	unsigned char overmap;
+};
+class Coplanar{
+public:
+	unsigned short ea;
+	unsigned char v0;
+	unsigned char v1;
+};
+
+int AssertIntact(HullContext &hc,ConvexH &convex) {
+	int i;
+	int estart=0;
+	for(i=0;i<convex.edges.count;i++) {
+		if(convex.edges[estart].p!= convex.edges[i].p) {
+			estart=i;
+		}
+		int inext = i+1;
+		if(inext>= convex.edges.count || convex.edges[inext].p != convex.edges[i].p) {
+			inext = estart;
+		}
+		assert(convex.edges[inext].p == convex.edges[i].p);
+		HalfEdge &edge = convex.edges[i];
+		int nb = convex.edges[i].ea;
+		assert(nb!=255);
+		if(nb==255 || nb==-1) return 0;
+		assert(nb!=-1);
+		assert(i== convex.edges[nb].ea);
+	}
+	for(i=0;i<convex.edges.count;i++) {
+		assert(COPLANAR==PlaneTest(hc,convex.facets[convex.edges[i].p],convex.vertices[convex.edges[i].v]));
+		if(COPLANAR!=PlaneTest(hc,convex.facets[convex.edges[i].p],convex.vertices[convex.edges[i].v])) return 0;
+		if(convex.edges[estart].p!= convex.edges[i].p) {
+			estart=i;
+		}
+		int i1 = i+1;
+		if(i1>= convex.edges.count || convex.edges[i1].p != convex.edges[i].p) {
+			i1 = estart;
+		}
+		int i2 = i1+1;
+		if(i2>= convex.edges.count || convex.edges[i2].p != convex.edges[i].p) {
+			i2 = estart;
+		}
+		if(i==i2) continue; // i sliced tangent to an edge and created 2 meaningless edges
+		REAL3 localnormal = TriNormal(convex.vertices[convex.edges[i ].v],
+			                           convex.vertices[convex.edges[i1].v],
+			                           convex.vertices[convex.edges[i2].v]);
+		//assert(dot(localnormal,convex.facets[convex.edges[i].p].normal)>0);//Commented out on Stan Melax' advice
+		if(dot(localnormal,convex.facets[convex.edges[i].p].normal)<=0)return 0;
+	}
+	return 1;
+}
+
+// back to back quads
+ConvexH *test_btbq()
+{
+
+#if STANDALONE
+	ConvexH *convex = new ConvexH(4,8,2);
+#else
+	ConvexH *convex = NX_NEW_MEM(ConvexH(4,8,2), CONVEX_TEMP);
+#endif
+
+	convex->vertices[0] = REAL3(0,0,0);
+	convex->vertices[1] = REAL3(1,0,0);
+	convex->vertices[2] = REAL3(1,1,0);
+	convex->vertices[3] = REAL3(0,1,0);
+	convex->facets[0] = Plane(REAL3(0,0,1),0);
+	convex->facets[1] = Plane(REAL3(0,0,-1),0);
+	convex->edges[0]  = HalfEdge(7,0,0);
+	convex->edges[1]  = HalfEdge(6,1,0);
+	convex->edges[2]  = HalfEdge(5,2,0);
+	convex->edges[3]  = HalfEdge(4,3,0);
+
+	convex->edges[4]  = HalfEdge(3,0,1);
+	convex->edges[5]  = HalfEdge(2,3,1);
+	convex->edges[6]  = HalfEdge(1,2,1);
+	convex->edges[7]  = HalfEdge(0,1,1);
+	HullContext hc;
+	AssertIntact(hc,*convex);
+	return convex;
+}
+
+ConvexH *test_cube()
+{
+#if STANDALONE
+	ConvexH *convex = new ConvexH(8,24,6);
+#else
+	ConvexH *convex = NX_NEW_MEM(ConvexH(8,24,6), CONVEX_TEMP);
+#endif
+	convex->vertices[0] = REAL3(0,0,0);
+	convex->vertices[1] = REAL3(0,0,1);
+	convex->vertices[2] = REAL3(0,1,0);
+	convex->vertices[3] = REAL3(0,1,1);
+	convex->vertices[4] = REAL3(1,0,0);
+	convex->vertices[5] = REAL3(1,0,1);
+	convex->vertices[6] = REAL3(1,1,0);
+	convex->vertices[7] = REAL3(1,1,1);
+
+	convex->facets[0] = Plane(REAL3(-1,0,0),0);
+	convex->facets[1] = Plane(REAL3(1,0,0),-1);
+	convex->facets[2] = Plane(REAL3(0,-1,0),0);
+	convex->facets[3] = Plane(REAL3(0,1,0),-1);
+	convex->facets[4] = Plane(REAL3(0,0,-1),0);
+	convex->facets[5] = Plane(REAL3(0,0,1),-1);
+
+	convex->edges[0 ] = HalfEdge(11,0,0);
+	convex->edges[1 ] = HalfEdge(23,1,0);
+	convex->edges[2 ] = HalfEdge(15,3,0);
+	convex->edges[3 ] = HalfEdge(16,2,0);
+
+	convex->edges[4 ] = HalfEdge(13,6,1);
+	convex->edges[5 ] = HalfEdge(21,7,1);
+	convex->edges[6 ] = HalfEdge( 9,5,1);
+	convex->edges[7 ] = HalfEdge(18,4,1);
+
+	convex->edges[8 ] = HalfEdge(19,0,2);
+	convex->edges[9 ] = HalfEdge( 6,4,2);
+	convex->edges[10] = HalfEdge(20,5,2);
+	convex->edges[11] = HalfEdge( 0,1,2);
+
+	convex->edges[12] = HalfEdge(22,3,3);
+	convex->edges[13] = HalfEdge( 4,7,3);
+	convex->edges[14] = HalfEdge(17,6,3);
+	convex->edges[15] = HalfEdge( 2,2,3);
+
+	convex->edges[16] = HalfEdge( 3,0,4);
+	convex->edges[17] = HalfEdge(14,2,4);
+	convex->edges[18] = HalfEdge( 7,6,4);
+	convex->edges[19] = HalfEdge( 8,4,4);
+	
+	convex->edges[20] = HalfEdge(10,1,5);
+	convex->edges[21] = HalfEdge( 5,5,5);
+	convex->edges[22] = HalfEdge(12,7,5);
+	convex->edges[23] = HalfEdge( 1,3,5);
+
+	
+	return convex;
+}
+ConvexH *ConvexHMakeCube(const REAL3 &bmin, const REAL3 &bmax) {
+	ConvexH *convex = test_cube();
+	convex->vertices[0] = REAL3(bmin.x,bmin.y,bmin.z);
+	convex->vertices[1] = REAL3(bmin.x,bmin.y,bmax.z);
+	convex->vertices[2] = REAL3(bmin.x,bmax.y,bmin.z);
+	convex->vertices[3] = REAL3(bmin.x,bmax.y,bmax.z);
+	convex->vertices[4] = REAL3(bmax.x,bmin.y,bmin.z);
+	convex->vertices[5] = REAL3(bmax.x,bmin.y,bmax.z);
+	convex->vertices[6] = REAL3(bmax.x,bmax.y,bmin.z);
+	convex->vertices[7] = REAL3(bmax.x,bmax.y,bmax.z);
+
+	convex->facets[0] = Plane(REAL3(-1,0,0), bmin.x);
+	convex->facets[1] = Plane(REAL3(1,0,0), -bmax.x);
+	convex->facets[2] = Plane(REAL3(0,-1,0), bmin.y);
+	convex->facets[3] = Plane(REAL3(0,1,0), -bmax.y);
+	convex->facets[4] = Plane(REAL3(0,0,-1), bmin.z);
+	convex->facets[5] = Plane(REAL3(0,0,1), -bmax.z);
+	return convex;
+}
+ConvexH *ConvexHCrop(HullContext &hc,ConvexH &convex,const Plane &slice)
+{
+	int i;
+	int vertcountunder=0;
+	int vertcountover =0;
+	int edgecountunder=0;
+	int edgecountover =0;
+	int planecountunder=0;
+	int planecountover =0;
+
+	assert(convex.edges.count<480);
+
+	EdgeFlag  edgeflag[512];
+	VertFlag  vertflag[256];
+	PlaneFlag planeflag[128];
+	HalfEdge  tmpunderedges[512];
+	Plane	  tmpunderplanes[128];
+	Coplanar coplanaredges[512];
+	int coplanaredges_num=0;
+
+	Array<REAL3> createdverts;
+	// do the side-of-plane tests
+	for(i=0;i<convex.vertices.count;i++) {
+		vertflag[i].planetest = PlaneTest(hc,slice,convex.vertices[i]);
+		if(vertflag[i].planetest == COPLANAR) {
+			// ? vertscoplanar.Add(i);
+			vertflag[i].undermap = vertcountunder++;
+			vertflag[i].overmap  = vertcountover++;
+		}
+		else if(vertflag[i].planetest == UNDER)	{
+			vertflag[i].undermap = vertcountunder++;
+		}
+		else {
+			assert(vertflag[i].planetest == OVER);
+			vertflag[i].overmap  = vertcountover++;
+			vertflag[i].undermap = (unsigned char)-1; // for debugging purposes
+		}
+	}
+	int vertcountunderold = vertcountunder; // for debugging only
+
+	int under_edge_count =0;
+	int underplanescount=0;
+	int e0=0;
+
+	for(int currentplane=0; currentplane<convex.facets.count; currentplane++) {
+		int estart =e0;
+		int enextface;
+		int planeside = 0;
+		int e1 = e0+1;
+		int eus=-1;
+		int ecop=-1;
+		int vout=-1;
+		int vin =-1;
+		int coplanaredge = -1;
+		do{
+
+			if(e1 >= convex.edges.count || convex.edges[e1].p!=currentplane) {
+				enextface = e1;
+				e1=estart;
+			}
+			HalfEdge &edge0 = convex.edges[e0];
+			HalfEdge &edge1 = convex.edges[e1];
+			HalfEdge &edgea = convex.edges[edge0.ea];
+
+
+			planeside |= vertflag[edge0.v].planetest;
+			//if((vertflag[edge0.v].planetest & vertflag[edge1.v].planetest)  == COPLANAR) {
+			//	assert(ecop==-1);
+			//	ecop=e;
+			//}
+
+
+			if(vertflag[edge0.v].planetest == OVER && vertflag[edge1.v].planetest == OVER){
+				// both endpoints over plane
+				edgeflag[e0].undermap  = -1;
+			}
+			else if((vertflag[edge0.v].planetest | vertflag[edge1.v].planetest)  == UNDER) {
+				// at least one endpoint under, the other coplanar or under
+				
+				edgeflag[e0].undermap = under_edge_count;
+				tmpunderedges[under_edge_count].v = vertflag[edge0.v].undermap;
+				tmpunderedges[under_edge_count].p = underplanescount;
+				if(edge0.ea < e0) {
+					// connect the neighbors
+					assert(edgeflag[edge0.ea].undermap !=-1);
+					tmpunderedges[under_edge_count].ea = edgeflag[edge0.ea].undermap;
+					tmpunderedges[edgeflag[edge0.ea].undermap].ea = under_edge_count;
+				}
+				under_edge_count++;
+			}
+			else if((vertflag[edge0.v].planetest | vertflag[edge1.v].planetest)  == COPLANAR) {
+				// both endpoints coplanar 
+				// must check a 3rd point to see if UNDER
+				int e2 = e1+1; 
+				if(e2>=convex.edges.count || convex.edges[e2].p!=currentplane) {
+					e2 = estart;
+				}
+				assert(convex.edges[e2].p==currentplane);
+				HalfEdge &edge2 = convex.edges[e2];
+				if(vertflag[edge2.v].planetest==UNDER) {
+					
+					edgeflag[e0].undermap = under_edge_count;
+					tmpunderedges[under_edge_count].v = vertflag[edge0.v].undermap;
+					tmpunderedges[under_edge_count].p = underplanescount;
+					tmpunderedges[under_edge_count].ea = -1;
+					// make sure this edge is added to the "coplanar" list
+					coplanaredge = under_edge_count;
+					vout = vertflag[edge0.v].undermap;
+					vin  = vertflag[edge1.v].undermap;
+					under_edge_count++;
+				}
+				else {
+					edgeflag[e0].undermap = -1;
+				}
+			}
+			else if(vertflag[edge0.v].planetest == UNDER && vertflag[edge1.v].planetest == OVER) {
+				// first is under 2nd is over 
+				
+				edgeflag[e0].undermap = under_edge_count;
+				tmpunderedges[under_edge_count].v = vertflag[edge0.v].undermap;
+				tmpunderedges[under_edge_count].p = underplanescount;
+				if(edge0.ea < e0) {
+					assert(edgeflag[edge0.ea].undermap !=-1);
+					// connect the neighbors
+					tmpunderedges[under_edge_count].ea = edgeflag[edge0.ea].undermap;
+					tmpunderedges[edgeflag[edge0.ea].undermap].ea = under_edge_count;
+					vout = tmpunderedges[edgeflag[edge0.ea].undermap].v;
+				}
+				else {
+					Plane &p0 = convex.facets[edge0.p];
+					Plane &pa = convex.facets[edgea.p];
+					createdverts.Add(ThreePlaneIntersection(p0,pa,slice));
+					//createdverts.Add(PlaneProject(slice,PlaneLineIntersection(slice,convex.vertices[edge0.v],convex.vertices[edgea.v])));
+					//createdverts.Add(PlaneLineIntersection(slice,convex.vertices[edge0.v],convex.vertices[edgea.v]));
+					vout = vertcountunder++;
+				}
+				under_edge_count++;
+				/// hmmm something to think about: i might be able to output this edge regarless of 
+				// wheter or not we know v-in yet.  ok i;ll try this now:
+				tmpunderedges[under_edge_count].v = vout;
+				tmpunderedges[under_edge_count].p = underplanescount;
+				tmpunderedges[under_edge_count].ea = -1;
+				coplanaredge = under_edge_count;
+				under_edge_count++;
+
+				if(vin!=-1) {
+					// we previously processed an edge  where we came under
+					// now we know about vout as well
+
+					// ADD THIS EDGE TO THE LIST OF EDGES THAT NEED NEIGHBOR ON PARTITION PLANE!!
+				}
+
+			}
+			else if(vertflag[edge0.v].planetest == COPLANAR && vertflag[edge1.v].planetest == OVER) {
+				// first is coplanar 2nd is over 
+				
+				edgeflag[e0].undermap = -1;
+				vout = vertflag[edge0.v].undermap;
+				// I hate this but i have to make sure part of this face is UNDER before ouputting this vert
+				int k=estart;
+				assert(edge0.p == currentplane);
+				while(!(planeside&UNDER) && k<convex.edges.count && convex.edges[k].p==edge0.p) {
+					planeside |= vertflag[convex.edges[k].v].planetest;
+					k++;
+				}
+				if(planeside&UNDER){
+					tmpunderedges[under_edge_count].v = vout;
+					tmpunderedges[under_edge_count].p = underplanescount;
+					tmpunderedges[under_edge_count].ea = -1;
+					coplanaredge = under_edge_count; // hmmm should make a note of the edge # for later on
+					under_edge_count++;
+					
+				}
+			}
+			else if(vertflag[edge0.v].planetest == OVER && vertflag[edge1.v].planetest == UNDER) {
+				// first is over next is under 
+				// new vertex!!!
+				if (vin!=-1) return NULL;
+				if(e0<edge0.ea) {
+					Plane &p0 = convex.facets[edge0.p];
+					Plane &pa = convex.facets[edgea.p];
+					createdverts.Add(ThreePlaneIntersection(p0,pa,slice));
+					//createdverts.Add(PlaneLineIntersection(slice,convex.vertices[edge0.v],convex.vertices[edgea.v]));
+					//createdverts.Add(PlaneProject(slice,PlaneLineIntersection(slice,convex.vertices[edge0.v],convex.vertices[edgea.v])));
+					vin = vertcountunder++;
+				}
+				else {
+					// find the new vertex that was created by edge[edge0.ea]
+					int nea = edgeflag[edge0.ea].undermap;
+					assert(tmpunderedges[nea].p==tmpunderedges[nea+1].p);
+					vin = tmpunderedges[nea+1].v;
+					assert(vin < vertcountunder);
+					assert(vin >= vertcountunderold);   // for debugging only
+				}
+				if(vout!=-1) {
+					// we previously processed an edge  where we went over
+					// now we know vin too
+					// ADD THIS EDGE TO THE LIST OF EDGES THAT NEED NEIGHBOR ON PARTITION PLANE!!
+				}
+				// output edge
+				tmpunderedges[under_edge_count].v = vin;
+				tmpunderedges[under_edge_count].p = underplanescount;
+				edgeflag[e0].undermap = under_edge_count;
+				if(e0>edge0.ea) {
+					assert(edgeflag[edge0.ea].undermap !=-1);
+					// connect the neighbors
+					tmpunderedges[under_edge_count].ea = edgeflag[edge0.ea].undermap;
+					tmpunderedges[edgeflag[edge0.ea].undermap].ea = under_edge_count;
+				}
+				assert(edgeflag[e0].undermap == under_edge_count);
+				under_edge_count++;
+			}
+			else if(vertflag[edge0.v].planetest == OVER && vertflag[edge1.v].planetest == COPLANAR) {
+				// first is over next is coplanar 
+				
+				edgeflag[e0].undermap = -1;
+				vin = vertflag[edge1.v].undermap;
+				if (vin==-1) return NULL;
+				if(vout!=-1) {
+					// we previously processed an edge  where we came under
+					// now we know both endpoints
+					// ADD THIS EDGE TO THE LIST OF EDGES THAT NEED NEIGHBOR ON PARTITION PLANE!!
+				}
+
+			}
+			else {
+				assert(0);
+			}
+			
+
+			e0=e1;
+			e1++; // do the modulo at the beginning of the loop
+
+		} while(e0!=estart) ;
+		e0 = enextface;
+		if(planeside&UNDER) {
+			planeflag[currentplane].undermap = underplanescount;
+			tmpunderplanes[underplanescount] = convex.facets[currentplane];
+			underplanescount++;
+		}
+		else {
+			planeflag[currentplane].undermap = 0;
+		}
+		if(vout>=0 && (planeside&UNDER)) {
+			assert(vin>=0);
+			assert(coplanaredge>=0);
+			assert(coplanaredge!=511);
+			coplanaredges[coplanaredges_num].ea = coplanaredge;
+			coplanaredges[coplanaredges_num].v0 = vin;
+			coplanaredges[coplanaredges_num].v1 = vout;
+			coplanaredges_num++;
+		}
+	}
+
+	// add the new plane to the mix:
+	if(coplanaredges_num>0) {
+		tmpunderplanes[underplanescount++]=slice;
+	}
+	for(i=0;i<coplanaredges_num-1;i++) {
+		if(coplanaredges[i].v1 != coplanaredges[i+1].v0) {
+			int j = 0;
+			for(j=i+2;j<coplanaredges_num;j++) {
+				if(coplanaredges[i].v1 == coplanaredges[j].v0) {
+					Coplanar tmp = coplanaredges[i+1];
+					coplanaredges[i+1] = coplanaredges[j];
+					coplanaredges[j] = tmp;
+					break;
+				}
+			}
+			if(j>=coplanaredges_num)
+			{
+				// assert(j<coplanaredges_num);
+				return NULL;
+			}
+		}
+	}
+#if STANDALONE
+	ConvexH *punder = new ConvexH(vertcountunder,under_edge_count+coplanaredges_num,underplanescount);
+#else
+	ConvexH *punder = NX_NEW_MEM(ConvexH(vertcountunder,under_edge_count+coplanaredges_num,underplanescount), CONVEX_TEMP);
+#endif
+
+	ConvexH &under = *punder;
+	int k=0;
+	for(i=0;i<convex.vertices.count;i++) {
+		if(vertflag[i].planetest != OVER){
+			under.vertices[k++] = convex.vertices[i];
+		}
+	}
+	i=0;
+	while(k<vertcountunder) {
+		under.vertices[k++] = createdverts[i++];
+	}
+	assert(i==createdverts.count);
+
+	for(i=0;i<coplanaredges_num;i++) {
+		under.edges[under_edge_count+i].p  = underplanescount-1;
+		under.edges[under_edge_count+i].ea = coplanaredges[i].ea;
+		tmpunderedges[coplanaredges[i].ea].ea = under_edge_count+i;
+		under.edges[under_edge_count+i].v  = coplanaredges[i].v0;
+	}
+
+	memcpy(under.edges.element,tmpunderedges,sizeof(HalfEdge)*under_edge_count);
+	memcpy(under.facets.element,tmpunderplanes,sizeof(Plane)*underplanescount);
+	return punder;
+}
+
+
+static int candidateplane(HullContext &hc,Plane *planes,int planes_count,ConvexH *convex,Real epsilon)
+{
+	int p =-1;
+	REAL md=0;
+	int i,j;
+	Real maxdot_minang = cos(DEG2RAD*hc.minadjangle);
+	for(i=0;i<planes_count;i++)
+	{
+		Real d=0;
+		Real dmax=0;
+		Real dmin=0;
+		for(j=0;j<convex->vertices.count;j++)
+		{
+			dmax = Max(dmax,dot(convex->vertices[j],planes[i].normal)+planes[i].dist);
+			dmin = Min(dmin,dot(convex->vertices[j],planes[i].normal)+planes[i].dist);
+		}
+		Real dr = dmax-dmin;
+		if(dr<hc.planetestepsilon) dr=1.0f; // shouldn't happen.
+		d = dmax /dr;
+		if(d<=md) continue;
+		for(j=0;j<convex->facets.count;j++)
+		{
+			if(planes[i]==convex->facets[j]) 
+			{
+				d=0;continue;
+			}
+			if(dot(planes[i].normal,convex->facets[j].normal)>maxdot_minang)
+			{
+				for(int k=0;k<convex->edges.count;k++)
+				{
+					if(convex->edges[k].p!=j) continue;
+					if(dot(convex->vertices[convex->edges[k].v],planes[i].normal)+planes[i].dist<0)
+					{
+						d=0; // so this plane wont get selected.
+						break;
+					}
+				}
+			}
+		}
+		if(d>md)
+		{
+			p=i;
+			md=d;
+		}
+	}
+	return (md>epsilon)?p:-1;
+}
+
+
+
+//*****************************************************
+//*** Support point kernels
+//*****************************************************
+// maxdir and maxdirfiltered return the index of the point furthest along dir,
+// the first one on ties, skipping points whose allow[] entry is zero.  They run
+// on every support query, so there are SSE2/AVX2/AVX-512 versions picked at run
+// time from what the cpu supports.  All of them compute the dot product as
+// (x*dx + y*dy) + z*dz without fused multiply-adds, and keep the first index on
+// ties, so every kernel returns exactly the same index as the scalar one.
+
+
+typedef int (*MaxDirKernel)(const real3 *p,int count,const real3 &dir,const int *allow);
+
+// Folds points [from,count) into the running best m/dm one at a time.
+static HULL_NOCONTRACT void maxdirtail(const real3 *p,int from,int count,const real3 &dir,const int *allow,int &m,Real &dm)
+{
+	HULL_PRECISE_BLOCK
+	for(int i=from;i<count;i++)
+	{
+		if(allow && !allow[i]) continue;
+		Real d = (p[i].x*dir.x + p[i].y*dir.y) + p[i].z*dir.z;
+		if(m==-1 || d>dm)
+		{
+			m  = i;
+			dm = d;
+		}
+	}
+}
+
+static int maxdirscalar(const real3 *p,int count,const real3 &dir,const int *allow)
+{
+	int    m  = -1;
+	Real dm = 0;
+	maxdirtail(p,0,count,dir,allow,m,dm);
+	return m;
+}
+
+#if HULL_SIMD_X86 && !HULL_REAL_FLOAT
+
+// Merges the per lane winners.  Each lane holds the first index of its own maximum,
+// so taking the largest value and the smallest index among equal values gives the
+// same answer as a front to back scan.
+static void maxdirlanes(const double *bv,const double *bi,int lanes,int &m,double &dm)
+{
+	for(int k=0;k<lanes;k++)
+	{
+		if(bi[k]<0) continue;
+		int i = (int) bi[k];
+		if(m==-1 || bv[k]>dm || (bv[k]==dm && i<m))
+		{
+			m  = i;
+			dm = bv[k];
+		}
+	}
+}
+
+static HULL_TARGET("sse2") HULL_NOCONTRACT int maxdirsse2(const real3 *p,int count,const real3 &dir,const int *allow)
+{
+	HULL_PRECISE_BLOCK
+	const double *f = &p[0].x;
+	const __m128d dx   = _mm_set1_pd(dir.x);
+	const __m128d dy   = _mm_set1_pd(dir.y);
+	const __m128d dz   = _mm_set1_pd(dir.z);
+	const __m128d zero = _mm_setzero_pd();
+	const __m128d step = _mm_set1_pd(2.0);
+	__m128d best    = _mm_setzero_pd();
+	__m128d bestidx = _mm_set1_pd(-1.0);
+	__m128d idx     = _mm_set_pd(1.0,0.0);
+	int i=0;
+	for(;i+2<=count;i+=2,f+=6)
+	{
+		// [x0 y0] [z0 x1] [y1 z1] -> [x0 x1] [y0 y1] [z0 z1]
+		__m128d l0 = _mm_loadu_pd(f);
+		__m128d l1 = _mm_loadu_pd(f+2);
+		__m128d l2 = _mm_loadu_pd(f+4);
+		__m128d x  = _mm_shuffle_pd(l0,l1,2);
+		__m128d y  = _mm_shuffle_pd(l0,l2,1);
+		__m128d z  = _mm_shuffle_pd(l1,l2,2);
+		__m128d d  = _mm_add_pd(_mm_add_pd(_mm_mul_pd(x,dx),_mm_mul_pd(y,dy)),_mm_mul_pd(z,dz));
+		__m128d take = _mm_or_pd(_mm_cmpgt_pd(d,best),_mm_cmplt_pd(bestidx,zero));
+		if(allow)
+		{
+			__m128i a = _mm_cmpeq_epi32(_mm_loadl_epi64((const __m128i *)(allow+i)),_mm_setzero_si128());
+			take = _mm_andnot_pd(_mm_castsi128_pd(_mm_unpacklo_epi32(a,a)),take);
+		}
+		best    = _mm_or_pd(_mm_and_pd(take,d),_mm_andnot_pd(take,best));
+		bestidx = _mm_or_pd(_mm_and_pd(take,idx),_mm_andnot_pd(take,bestidx));
+		idx     = _mm_add_pd(idx,step);
+	}
+	double bv[2],bi[2];
+	_mm_storeu_pd(bv,best);
+	_mm_storeu_pd(bi,bestidx);
+	int    m  = -1;
+	double dm = 0;
+	maxdirlanes(bv,bi,2,m,dm);
+	maxdirtail(p,i,count,dir,allow,m,dm);
+	return m;
+}
+
+static HULL_TARGET("avx2") HULL_NOCONTRACT int maxdiravx2(const real3 *p,int count,const real3 &dir,const int *allow)
+{
+	HULL_PRECISE_BLOCK
+	const double *f = &p[0].x;
+	const __m256d dx   = _mm256_set1_pd(dir.x);
+	const __m256d dy   = _mm256_set1_pd(dir.y);
+	const __m256d dz   = _mm256_set1_pd(dir.z);
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d step = _mm256_set1_pd(4.0);
+	__m256d best    = _mm256_setzero_pd();
+	__m256d bestidx = _mm256_set1_pd(-1.0);
+	__m256d idx     = _mm256_set_pd(3.0,2.0,1.0,0.0);
+	int i=0;
+	for(;i+4<=count;i+=4,f+=12)
+	{
+		// [x0 y0 z0 x1] [y1 z1 x2 y2] [z2 x3 y3 z3] -> [x0 x1 x2 x3] [y0 y1 y2 y3] [z0 z1 z2 z3]
+		__m256d l0 = _mm256_loadu_pd(f);
+		__m256d l1 = _mm256_loadu_pd(f+4);
+		__m256d l2 = _mm256_loadu_pd(f+8);
+		__m256d m0 = _mm256_permute2f128_pd(l0,l1,0x30); // x0 y0 x2 y2
+		__m256d m1 = _mm256_permute2f128_pd(l0,l2,0x21); // z0 x1 z2 x3
+		__m256d m2 = _mm256_permute2f128_pd(l1,l2,0x30); // y1 z1 y3 z3
+		__m256d x  = _mm256_blend_pd(m0,m1,0xA);
+		__m256d y  = _mm256_shuffle_pd(m0,m2,0x5);
+		__m256d z  = _mm256_blend_pd(m1,m2,0xA);
+		__m256d d  = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x,dx),_mm256_mul_pd(y,dy)),_mm256_mul_pd(z,dz));
+		__m256d take = _mm256_or_pd(_mm256_cmp_pd(d,best,_CMP_GT_OQ),_mm256_cmp_pd(bestidx,zero,_CMP_LT_OQ));
+		if(allow)
+		{
+			__m128i a = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(allow+i)),_mm_setzero_si128());
+			take = _mm256_andnot_pd(_mm256_castsi256_pd(_mm256_cvtepi32_epi64(a)),take);
+		}
+		best    = _mm256_blendv_pd(best,d,take);
+		bestidx = _mm256_blendv_pd(bestidx,idx,take);
+		idx     = _mm256_add_pd(idx,step);
+	}
+	double bv[4],bi[4];
+	_mm256_storeu_pd(bv,best);
+	_mm256_storeu_pd(bi,bestidx);
+	int    m  = -1;
+	double dm = 0;
+	maxdirlanes(bv,bi,4,m,dm);
+	maxdirtail(p,i,count,dir,allow,m,dm);
+	return m;
+}
+
+static HULL_TARGET("avx512f") HULL_NOCONTRACT int maxdiravx512(const real3 *p,int count,const real3 &dir,const int *allow)
+{
+	HULL_PRECISE_BLOCK
+	const double *f = &p[0].x;
+	const __m512d dx   = _mm512_set1_pd(dir.x);
+	const __m512d dy   = _mm512_set1_pd(dir.y);
+	const __m512d dz   = _mm512_set1_pd(dir.z);
+	const __m512d zero = _mm512_setzero_pd();
+	const __m512d step = _mm512_set1_pd(8.0);
+	// gather x, y and z of 8 consecutive points out of the three 8 wide loads
+	const __m512i xa = _mm512_set_epi64( 0, 0,15,12, 9, 6, 3, 0);
+	const __m512i xb = _mm512_set_epi64(13,10, 5, 4, 3, 2, 1, 0);
+	const __m512i ya = _mm512_set_epi64( 0, 0, 0,13,10, 7, 4, 1);
+	const __m512i yb = _mm512_set_epi64(14,11, 8, 4, 3, 2, 1, 0);
+	const __m512i za = _mm512_set_epi64( 0, 0, 0,14,11, 8, 5, 2);
+	const __m512i zb = _mm512_set_epi64(15,12, 9, 4, 3, 2, 1, 0);
+	__m512d best    = _mm512_setzero_pd();
+	__m512d bestidx = _mm512_set1_pd(-1.0);
+	__m512d idx     = _mm512_set_pd(7.0,6.0,5.0,4.0,3.0,2.0,1.0,0.0);
+	int i=0;
+	for(;i+8<=count;i+=8,f+=24)
+	{
+		__m512d l0 = _mm512_loadu_pd(f);
+		__m512d l1 = _mm512_loadu_pd(f+8);
+		__m512d l2 = _mm512_loadu_pd(f+16);
+		__m512d x  = _mm512_permutex2var_pd(_mm512_permutex2var_pd(l0,xa,l1),xb,l2);
+		__m512d y  = _mm512_permutex2var_pd(_mm512_permutex2var_pd(l0,ya,l1),yb,l2);
+		__m512d z  = _mm512_permutex2var_pd(_mm512_permutex2var_pd(l0,za,l1),zb,l2);
+		__m512d d  = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(x,dx),_mm512_mul_pd(y,dy)),_mm512_mul_pd(z,dz));
+		__mmask8 take = _mm512_cmp_pd_mask(d,best,_CMP_GT_OQ) | _mm512_cmp_pd_mask(bestidx,zero,_CMP_LT_OQ);
+		if(allow)
+		{
+			__m512i a = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)(allow+i)));
+			take &= _mm512_test_epi64_mask(a,a);
+		}
+		best    = _mm512_mask_blend_pd(take,best,d);
+		bestidx = _mm512_mask_blend_pd(take,bestidx,idx);
+		idx     = _mm512_add_pd(idx,step);
+	}
+	double bv[8],bi[8];
+	_mm512_storeu_pd(bv,best);
+	_mm512_storeu_pd(bi,bestidx);
+	int    m  = -1;
+	double dm = 0;
+	maxdirlanes(bv,bi,8,m,dm);
+	maxdirtail(p,i,count,dir,allow,m,dm);
+	return m;
+}
+
+
+#elif HULL_SIMD_X86
+
+// The float build keeps the lane indices as integers, a float could not count
+// past 2^24 points.
+
+// Merges the per lane winners, see the double version.
+static void maxdirlanes(const float *bv,const int *bi,int lanes,int &m,float &dm)
+{
+	for(int k=0;k<lanes;k++)
+	{
+		if(bi[k]<0) continue;
+		int i = bi[k];
+		if(m==-1 || bv[k]>dm || (bv[k]==dm && i<m))
+		{
+			m  = i;
+			dm = bv[k];
+		}
+	}
+}
+
+static HULL_TARGET("sse2") HULL_NOCONTRACT int maxdirsse2(const real3 *p,int count,const real3 &dir,const int *allow)
+{
+	HULL_PRECISE_BLOCK
+	const float *f = &p[0].x;
+	const __m128  dx    = _mm_set1_ps(dir.x);
+	const __m128  dy    = _mm_set1_ps(dir.y);
+	const __m128  dz    = _mm_set1_ps(dir.z);
+	const __m128i zeroi = _mm_setzero_si128();
+	const __m128i step  = _mm_set1_epi32(4);
+	__m128  best    = _mm_setzero_ps();
+	__m128i bestidx = _mm_set1_epi32(-1);
+	__m128i idx     = _mm_set_epi32(3,2,1,0);
+	int i=0;
+	for(;i+4<=count;i+=4,f+=12)
+	{
+		// [x0 y0 z0 x1] [y1 z1 x2 y2] [z2 x3 y3 z3] -> [x0 x1 x2 x3] [y0 y1 y2 y3] [z0 z1 z2 z3]
+		__m128 l0 = _mm_loadu_ps(f);
+		__m128 l1 = _mm_loadu_ps(f+4);
+		__m128 l2 = _mm_loadu_ps(f+8);
+		__m128 x  = _mm_shuffle_ps(l0,_mm_shuffle_ps(l1,l2,_MM_SHUFFLE(1,1,2,2)),_MM_SHUFFLE(2,0,3,0));
+		__m128 y  = _mm_shuffle_ps(_mm_shuffle_ps(l0,l1,_MM_SHUFFLE(0,0,1,1)),_mm_shuffle_ps(l1,l2,_MM_SHUFFLE(2,2,3,3)),_MM_SHUFFLE(2,0,2,0));
+		__m128 z  = _mm_shuffle_ps(_mm_shuffle_ps(l0,l1,_MM_SHUFFLE(1,1,2,2)),l2,_MM_SHUFFLE(3,0,2,0));
+		__m128 d  = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x,dx),_mm_mul_ps(y,dy)),_mm_mul_ps(z,dz));
+		__m128 take = _mm_or_ps(_mm_cmpgt_ps(d,best),_mm_castsi128_ps(_mm_cmplt_epi32(bestidx,zeroi)));
+		if(allow)
+		{
+			__m128i a = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(allow+i)),zeroi);
+			take = _mm_andnot_ps(_mm_castsi128_ps(a),take);
+		}
+		__m128i t = _mm_castps_si128(take);
+		best    = _mm_or_ps(_mm_and_ps(take,d),_mm_andnot_ps(take,best));
+		bestidx = _mm_or_si128(_mm_and_si128(t,idx),_mm_andnot_si128(t,bestidx));
+		idx     = _mm_add_epi32(idx,step);
+	}
+	float bv[4];
+	int   bi[4];
+	_mm_storeu_ps(bv,best);
+	_mm_storeu_si128((__m128i *)bi,bestidx);
+	int   m  = -1;
+	float dm = 0;
+	maxdirlanes(bv,bi,4,m,dm);
+	maxdirtail(p,i,count,dir,allow,m,dm);
+	return m;
+}
+
+static HULL_TARGET("avx2") HULL_NOCONTRACT int maxdiravx2(const real3 *p,int count,const real3 &dir,const int *allow)
+{
+	HULL_PRECISE_BLOCK
+	const float *f = &p[0].x;
+	const __m256  dx    = _mm256_set1_ps(dir.x);
+	const __m256  dy    = _mm256_set1_ps(dir.y);
+	const __m256  dz    = _mm256_set1_ps(dir.z);
+	const __m256i zeroi = _mm256_setzero_si256();
+	const __m256i step  = _mm256_set1_epi32(8);
+	// where x, y and z of 8 consecutive points sit in each of the three 8 wide loads
+	const __m256i x0 = _mm256_setr_epi32(0,3,6,0,0,0,0,0);
+	const __m256i x1 = _mm256_setr_epi32(0,0,0,1,4,7,0,0);
+	const __m256i x2 = _mm256_setr_epi32(0,0,0,0,0,0,2,5);
+	const __m256i y0 = _mm256_setr_epi32(1,4,7,0,0,0,0,0);
+	const __m256i y1 = _mm256_setr_epi32(0,0,0,2,5,0,0,0);
+	const __m256i y2 = _mm256_setr_epi32(0,0,0,0,0,0,3,6);
+	const __m256i z0 = _mm256_setr_epi32(2,5,0,0,0,0,0,0);
+	const __m256i z1 = _mm256_setr_epi32(0,0,0,3,6,0,0,0);
+	const __m256i z2 = _mm256_setr_epi32(0,0,0,0,0,1,4,7);
+	__m256  best    = _mm256_setzero_ps();
+	__m256i bestidx = _mm256_set1_epi32(-1);
+	__m256i idx     = _mm256_setr_epi32(0,1,2,3,4,5,6,7);
+	int i=0;
+	for(;i+8<=count;i+=8,f+=24)
+	{
+		__m256 l0 = _mm256_loadu_ps(f);
+		__m256 l1 = _mm256_loadu_ps(f+8);
+		__m256 l2 = _mm256_loadu_ps(f+16);
+		__m256 x  = _mm256_blend_ps(_mm256_blend_ps(_mm256_permutevar8x32_ps(l0,x0),_mm256_permutevar8x32_ps(l1,x1),0x38),_mm256_permutevar8x32_ps(l2,x2),0xC0);
+		__m256 y  = _mm256_blend_ps(_mm256_blend_ps(_mm256_permutevar8x32_ps(l0,y0),_mm256_permutevar8x32_ps(l1,y1),0x18),_mm256_permutevar8x32_ps(l2,y2),0xE0);
+		__m256 z  = _mm256_blend_ps(_mm256_blend_ps(_mm256_permutevar8x32_ps(l0,z0),_mm256_permutevar8x32_ps(l1,z1),0x1C),_mm256_permutevar8x32_ps(l2,z2),0xE0);
+		__m256 d  = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x,dx),_mm256_mul_ps(y,dy)),_mm256_mul_ps(z,dz));
+		__m256 take = _mm256_or_ps(_mm256_cmp_ps(d,best,_CMP_GT_OQ),_mm256_castsi256_ps(_mm256_cmpgt_epi32(zeroi,bestidx)));
+		if(allow)
+		{
+			__m256i a = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(allow+i)),zeroi);
+			take = _mm256_andnot_ps(_mm256_castsi256_ps(a),take);
+		}
+		best    = _mm256_blendv_ps(best,d,take);
+		bestidx = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestidx),_mm256_castsi256_ps(idx),take));
+		idx     = _mm256_add_epi32(idx,step);
+	}
+	float bv[8];
+	int   bi[8];
+	_mm256_storeu_ps(bv,best);
+	_mm256_storeu_si256((__m256i *)bi,bestidx);
+	int   m  = -1;
+	float dm = 0;
+	maxdirlanes(bv,bi,8,m,dm);
+	maxdirtail(p,i,count,dir,allow,m,dm);
+	return m;
+}
+
+static HULL_TARGET("avx512f") HULL_NOCONTRACT int maxdiravx512(const real3 *p,int count,const real3 &dir,const int *allow)
+{
+	HULL_PRECISE_BLOCK
+	const float *f = &p[0].x;
+	const __m512  dx    = _mm512_set1_ps(dir.x);
+	const __m512  dy    = _mm512_set1_ps(dir.y);
+	const __m512  dz    = _mm512_set1_ps(dir.z);
+	const __m512i zeroi = _mm512_setzero_si512();
+	const __m512i step  = _mm512_set1_epi32(16);
+	// gather x, y and z of 16 consecutive points out of the three 16 wide loads
+	const __m512i xa = _mm512_setr_epi32( 0, 3, 6, 9,12,15,18,21,24,27,30, 0, 0, 0, 0, 0);
+	const __m512i xb = _mm512_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,17,20,23,26,29);
+	const __m512i ya = _mm512_setr_epi32( 1, 4, 7,10,13,16,19,22,25,28,31, 0, 0, 0, 0, 0);
+	const __m512i yb = _mm512_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,18,21,24,27,30);
+	const __m512i za = _mm512_setr_epi32( 2, 5, 8,11,14,17,20,23,26,29, 0, 0, 0, 0, 0, 0);
+	const __m512i zb = _mm512_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,16,19,22,25,28,31);
+	__m512  best    = _mm512_setzero_ps();
+	__m512i bestidx = _mm512_set1_epi32(-1);
+	__m512i idx     = _mm512_setr_epi32(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
+	int i=0;
+	for(;i+16<=count;i+=16,f+=48)
+	{
+		__m512 l0 = _mm512_loadu_ps(f);
+		__m512 l1 = _mm512_loadu_ps(f+16);
+		__m512 l2 = _mm512_loadu_ps(f+32);
+		__m512 x  = _mm512_permutex2var_ps(_mm512_permutex2var_ps(l0,xa,l1),xb,l2);
+		__m512 y  = _mm512_permutex2var_ps(_mm512_permutex2var_ps(l0,ya,l1),yb,l2);
+		__m512 z  = _mm512_permutex2var_ps(_mm512_permutex2var_ps(l0,za,l1),zb,l2);
+		__m512 d  = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(x,dx),_mm512_mul_ps(y,dy)),_mm512_mul_ps(z,dz));
+		__mmask16 take = _mm512_cmp_ps_mask(d,best,_CMP_GT_OQ) | _mm512_cmplt_epi32_mask(bestidx,zeroi);
+		if(allow)
+		{
+			__m512i a = _mm512_loadu_si512((const void *)(allow+i));
+			take &= _mm512_test_epi32_mask(a,a);
+		}
+		best    = _mm512_mask_blend_ps(take,best,d);
+		bestidx = _mm512_mask_blend_epi32(take,bestidx,idx);
+		idx     = _mm512_add_epi32(idx,step);
+	}
+	float bv[16];
+	int   bi[16];
+	_mm512_storeu_ps(bv,best);
+	_mm512_storeu_si512((void *)bi,bestidx);
+	int   m  = -1;
+	float dm = 0;
+	maxdirlanes(bv,bi,16,m,dm);
+	maxdirtail(p,i,count,dir,allow,m,dm);
+	return m;
+}
+
+#endif // HULL_SIMD_X86
+
+static MaxDirKernel selectmaxdirkernel(void)
+{
+#if HULL_SIMD_X86
+	unsigned int r0[4],r1[4],r7[4]={0,0,0,0};
+	hullcpuid(0,0,r0);
+	hullcpuid(1,0,r1);
+	if(r0[0]>=7) hullcpuid(7,0,r7);
+	bool sse2    = (r1[3]&(1<<26))!=0;
+	bool osxsave = (r1[2]&(1<<27))!=0;
+	bool avx     = (r1[2]&(1<<28))!=0;
+	unsigned long long xcr0 = osxsave ? hullxgetbv() : 0;
+	bool ymm = (xcr0&0x06)==0x06;   // OS saves xmm/ymm state
+	bool zmm = (xcr0&0xE6)==0xE6;   // ... and opmask/zmm state
+	if(avx && zmm && (r7[1]&(1<<16))) return maxdiravx512;
+	if(avx && ymm && (r7[1]&(1<<5)))  return maxdiravx2;
+	if(sse2) return maxdirsse2;
+#endif
+	return maxdirscalar;
+}
+
+static MaxDirKernel maxdirkernel(void)
+{
+	static const MaxDirKernel kernel = selectmaxdirkernel();
+	return kernel;
+}
+
+inline int maxdir(const real3 *p,int count,const real3 &dir)
+{
+	assert(count);
+	return maxdirkernel()(p,count,dir,NULL);
+}
+
+
+#if HULL_THREADS
+
+#define PARALLEL_GRAIN 32768  // fewest points worth handing to a thread of their own
+#define PARALLEL_TASKS 4      // pieces per thread, so the pool has something to steal
+
+static HULL_NOCONTRACT Real maxdirdot(const real3 &p,const real3 &dir)
+{
+	HULL_PRECISE_BLOCK
+	return (p.x*dir.x + p.y*dir.y) + p.z*dir.z;
+}
+
+// Splits one support query into slices that run on the HullTaskPool.  Each slice
+// finds its own first maximum and the slices are merged keeping the first index
+// among equal values, so the answer is the same one the serial scan gives.
+class MaxDirJob
+{
+public:
+	enum { MAXTASKS = 256 };
+	const real3 *p;
+	real3        dir;
+	const int   *allow;
+	int          m[MAXTASKS];
+};
+
+static void maxdirtask(void *data,int task,int begin,int end)
+{
+	MaxDirJob *job = (MaxDirJob *) data;
+	int m = maxdirkernel()(job->p+begin,end-begin,job->dir,job->allow ? job->allow+begin : NULL);
+	job->m[task] = (m==-1) ? -1 : m+begin;
+}
+
+static int maxdirparallel(int threads,const real3 *p,int count,const real3 &dir,const int *allow)
+{
+	int tasks = Min(threads*PARALLEL_TASKS,count/PARALLEL_GRAIN);
+	if(tasks > MaxDirJob::MAXTASKS) tasks = MaxDirJob::MAXTASKS;
+	if(tasks < 2) return maxdirkernel()(p,count,dir,allow);
+	MaxDirJob job;
+	job.p     = p;
+	job.dir   = dir;
+	job.allow = allow;
+	HullTaskPool::Get().ParallelFor(count,tasks,maxdirtask,&job);
+	int  m  = -1;
+	Real dm = 0;
+	for(int i=0;i<tasks;i++)
+	{
+		if(job.m[i]==-1) continue;
+		Real d = maxdirdot(p[job.m[i]],dir);
+		if(m==-1 || d>dm)  // slices are in order, so a tie keeps the earlier index
+		{
+			m  = job.m[i];
+			dm = d;
+		}
+	}
+	return m;
+}
+
+#endif // HULL_THREADS
+
+int maxdirfiltered(HullContext &hc,const real3 *p,int count,const real3 &dir,Array<int> &allow)
+{
+	assert(count);
+#if HULL_THREADS
+	int m = (hc.threads>1) ? maxdirparallel(hc.threads,p,count,dir,allow.element) : maxdirkernel()(p,count,dir,allow.element);
+#else
+	int m = maxdirkernel()(p,count,dir,allow.element);
+#endif
+	assert(m!=-1);
+	return m;
+} 
+
+real3 orth(const real3 &v)
+{
+	real3 a=cross(v,real3(0,0,1));
+	real3 b=cross(v,real3(0,1,0));
+	return normalize((magnitude(a)>magnitude(b))?a:b);
+}
+
+
+template<class T>
+int maxdirsterid(HullContext &hc,const T *p,int count,const T &dir,Array<int> &allow)
+{
+	int m=-1;
+	while(m==-1)
+	{
+		m = maxdirfiltered(hc,p,count,dir,allow);
+		if(allow[m]==3 || hc.Expired()) return m;  // out of time, the furthest point will do
+		T u = orth(dir);
+		T v = cross(u,dir);
+		int ma=-1;
+		for(Real x = 0.0f ; x<= 360.0f ; x+= 45.0f)
+		{
+			Real s = sin(DEG2RAD*(x));
+			Real c = cos(DEG2RAD*(x));
+			int mb = maxdirfiltered(hc,p,count,dir+(u*s+v*c)*0.025f,allow);
+			if(ma==m && mb==m)
+			{
+				allow[m]=3;
+				return m;
+			}
+			if(ma!=-1 && ma!=mb)  // Yuck - this is really ugly
+			{
+				int mc = ma;
+				for(Real xx = x-40.0f ; xx <= x ; xx+= 5.0f)
+				{
+					Real s = sin(DEG2RAD*(xx));
+					Real c = cos(DEG2RAD*(xx));
+					int md = maxdirfiltered(hc,p,count,dir+(u*s+v*c)*0.025f,allow);
+					if(mc==m && md==m)
+					{
+						allow[m]=3;
+						return m;
+					}
+					mc=md;
+				}
+			}
+			ma=mb;
+		}
+		allow[m]=0;
+		m=-1;
+	}
+	assert(0);
+	return m;
+} 
+
+
+
+
+int operator ==(const int3 &a,const int3 &b) 
+{
+	for(int i=0;i<3;i++) 
+	{
+		if(a[i]!=b[i]) return 0;
+	}
+	return 1;
+}
+
+int3 roll3(int3 a) 
+{
+	int tmp=a[0];
+	a[0]=a[1];
+	a[1]=a[2];
+	a[2]=tmp;
+	return a;
+}
+int isa(const int3 &a,const int3 &b) 
+{
+	return ( a==b || roll3(a)==b || a==roll3(b) );
+}
+int b2b(const int3 &a,const int3 &b) 
+{
+	return isa(a,int3(b[2],b[1],b[0]));
+}
+int above(real3* vertices,const int3& t, const real3 &p, Real epsilon) 
+{
+	real3 n=TriNormal(vertices[t[0]],vertices[t[1]],vertices[t[2]]);
+	return (dot(n,p-vertices[t[0]]) > epsilon); // EPSILON???
+}
+// Whether p is strictly above the plane of t, decided exactly whatever the rounding.
+int aboveexact(real3* vertices,const int3& t, const real3 &p)
+{
+	double a[3],b[3],c[3],d[3];
+	for(int i=0;i<3;i++)
+	{
+		a[i] = vertices[t[0]][i];
+		b[i] = vertices[t[1]][i];
+		c[i] = vertices[t[2]][i];
+		d[i] = p[i];
+	}
+	return hullorient3d(a,b,c,d) > 0;
+}
+
+// Whether the vertex being added sees t, and so replaces it
+static int cansee(HullContext &hc,real3* vertices,const int3& t, const real3 &p, Real epsilon)
+{
+	return hc.exact ? aboveexact(vertices,t,p) : above(vertices,t,p,0.01f*epsilon);
+}
+
+int hasedge(const int3 &t, int a,int b)
+{
+	for(int i=0;i<3;i++)
+	{
+		int i1= (i+1)%3;
+		if(t[i]==a && t[i1]==b) return 1;
+	}
+	return 0;
+}
+int hasvert(const int3 &t, int v)
+{
+	return (t[0]==v || t[1]==v || t[2]==v) ;
+}
+int shareedge(const int3 &a,const int3 &b)
+{
+	int i;
+	for(i=0;i<3;i++)
+	{
+		int i1= (i+1)%3;
+		if(hasedge(a,b[i1],b[i])) return 1;
+	}
+	return 0;
+}
+
+class Tri : public int3
+{
+public:
+	int3 n;
+	int id;
+	int vmax;
+	Real rise;
+	int conflicts;  // first outside point owned by this triangle (QF_CONFLICT_LISTS), -1 if none.
+	int visit;      // the vertex this triangle was last tested against when flooding the visible region.
+	Tri(int a,int b,int c,int _id):int3(a,b,c),n(-1,-1,-1)
+	{
+		id = _id;
+		vmax=-1;
+		rise = 0.0f;
+		conflicts=-1;
+		visit=-1;
+	}
+	int &neib(int a,int b);
+};
+
+template <class Type> static size_t arraybytes(const Array<Type> &a)
+{
+	return sizeof(Type)*a.array_size;
+}
+
+size_t TriPool::WorkingSet(void) const
+{
+	return arraybytes(blocks) + arraybytes(freelist) + sizeof(Tri)*TRIPOOL_BLOCK*blocks.count;
+}
+
+size_t HullContext::WorkingSet(void) const
+{
+	return tripool.WorkingSet() + arraybytes(tris) + arraybytes(riseheap) + arraybytes(conflictnext) +
+	       arraybytes(orphans) + arraybytes(visible) + arraybytes(hints) + arraybytes(lodbudgets) +
+	       arraybytes(lodstart) + arraybytes(lodcount) + arraybytes(lodtris) + arraybytes(loderror) +
+	       arraybytes(pending) + arraybytes(owner) + arraybytes(ownerrise) + arraybytes(isextreme.bits) +
+	       arraybytes(allow) + arraybytes(targets) + arraybytes(normals) + arraybytes(edges) +
+	       arraybytes(hullindices) + arraybytes(cells) + arraybytes(cellpoints) + arraybytes(cellbounds);
+}
+
+size_t HullScratch::WorkingSet(void) const
+{
+	return hc.WorkingSet() + corners.WorkingSet() + arraybytes(vsource) + arraybytes(sources) +
+	       arraybytes(where) + arraybytes(weldheads) + arraybytes(weldnext) + arraybytes(planar) +
+	       arraybytes(outline) + arraybytes(extreme) + arraybytes(extremes) + arraybytes(planes) +
+	       arraybytes(keep) + arraybytes(vscratch) + arraybytes(oindex) + arraybytes(used) +
+	       arraybytes(morton) + arraybytes(column) + arraybytes(height) + arraybytes(corekept.bits) +
+	       arraybytes(coreset) + arraybytes(outvertices) + arraybytes(outindices) + arraybytes(outsources);
+}
+
+TriPool::~TriPool(void)
+{
+	for(int i=0;i<blocks.count;i++)
+	{
+		NX_FREE(blocks[i]);
+	}
+}
+
+Tri *TriPool::Alloc(void)
+{
+	if(freelist.count)
+	{
+		return freelist.Pop();
+	}
+	if(used==blocks.count*TRIPOOL_BLOCK)
+	{
+		blocks.Add((Tri *) NX_ALLOC(sizeof(Tri)*TRIPOOL_BLOCK, CONVEX_TEMP));
+	}
+	Tri *t = blocks[used/TRIPOOL_BLOCK] + (used%TRIPOOL_BLOCK);
+	used++;
+	return t;
+}
+
+Tri *allocatetri(HullContext &hc,int a,int b,int c)
+{
+	Tri *t = new (hc.tripool.Alloc()) Tri(a,b,c,hc.tris.count);
+	hc.tris.Add(t);
+	return t;
+}
+
+void deallocatetri(HullContext &hc,Tri *t)
+{
+	assert(hc.tris[t->id]==t);
+	hc.tris[t->id]=NULL;
+	if(t->conflicts>=0)
+	{
+		hc.orphans.Add(t->conflicts); // hand its outside points back for redistribution
+	}
+	hc.tripool.Free(t);
+}
+
+// Drops every triangle at once, keeping the pool's blocks for the next hull.
+void releasetris(HullContext &hc)
+{
+	hc.tris.count=0;
+	hc.tripool.Reset();
+	hc.riseheap.count=0;
+	hc.orphans.count=0;
+}
+
+
+int &Tri::neib(int a,int b)
+{
+	static int er=-1;
+	int i;
+	for(i=0;i<3;i++) 
+	{
+		int i1=(i+1)%3;
+		int i2=(i+2)%3;
+		if((*this)[i]==a && (*this)[i1]==b) return n[i2];
+		if((*this)[i]==b && (*this)[i1]==a) return n[i2];
+	}
+	assert(0);
+	return er;
+}
+void b2bfix(HullContext &hc,Tri* s,Tri*t)
+{
+	Array<Tri*> &tris = hc.tris;
+	int i;
+	for(i=0;i<3;i++) 
+	{
+		int i1=(i+1)%3;
+		int i2=(i+2)%3;
+		int a = (*s)[i1];
+		int b = (*s)[i2];
+		assert(tris[s->neib(a,b)]->neib(b,a) == s->id);
+		assert(tris[t->neib(a,b)]->neib(b,a) == t->id);
+		tris[s->neib(a,b)]->neib(b,a) = t->neib(b,a);
+		tris[t->neib(b,a)]->neib(a,b) = s->neib(a,b);
+	}
+}
+
+void removeb2b(HullContext &hc,Tri* s,Tri*t)
+{
+	b2bfix(hc,s,t);
+	deallocatetri(hc,s);
+	deallocatetri(hc,t);
+}
+
+void checkit(HullContext &hc,Tri *t)
+{
+	Array<Tri*> &tris = hc.tris;
+	int i;
+	assert(tris[t->id]==t);
+	for(i=0;i<3;i++)
+	{
+		int i1=(i+1)%3;
+		int i2=(i+2)%3;
+		int a = (*t)[i1];
+		int b = (*t)[i2];
+		assert(a!=b);
+		assert( tris[t->n[i]]->neib(b,a) == t->id);
+	}
+}
+void extrude(HullContext &hc,Tri *t0,int v)
+{
+	Array<Tri*> &tris = hc.tris;
+	int3 t= *t0;
+	int n = tris.count;
+	Tri* ta = allocatetri(hc,v,t[1],t[2]);
+	ta->n = int3(t0->n[0],n+1,n+2);
+	tris[t0->n[0]]->neib(t[1],t[2]) = n+0;
+	Tri* tb = allocatetri(hc,v,t[2],t[0]);
+	tb->n = int3(t0->n[1],n+2,n+0);
+	tris[t0->n[1]]->neib(t[2],t[0]) = n+1;
+	Tri* tc = allocatetri(hc,v,t[0],t[1]);
+	tc->n = int3(t0->n[2],n+0,n+1);
+	tris[t0->n[2]]->neib(t[0],t[1]) = n+2;
+	checkit(hc,ta);
+	checkit(hc,tb);
+	checkit(hc,tc);
+	if(hasvert(*tris[ta->n[0]],v)) removeb2b(hc,ta,tris[ta->n[0]]);
+	if(hasvert(*tris[tb->n[0]],v)) removeb2b(hc,tb,tris[tb->n[0]]);
+	if(hasvert(*tris[tc->n[0]],v)) removeb2b(hc,tc,tris[tc->n[0]]);
+	deallocatetri(hc,t0);
+
+}
+
+// Heap ordering for the rise heap.  Ties go to the older triangle so we pick
+// the same one a front to back scan of the triangle list would.
+static int riseabove(const TriRise &a,const TriRise &b)
+{
+	return (a.rise>b.rise || (a.rise==b.rise && a.id<b.id));
+}
+
+static void pushrise(HullContext &hc,Tri *t)
+{
+	Array<TriRise> &heap = hc.riseheap;
+	TriRise e;
+	e.rise = t->rise;
+	e.id   = t->id;
+	int i = heap.count;
+	heap.Add(e);
+	while(i>0)
+	{
+		int parent = (i-1)/2;
+		if(!riseabove(e,heap[parent])) break;
+		heap[i] = heap[parent];
+		i = parent;
+	}
+	heap[i] = e;
+}
+
+static void poprise(HullContext &hc)
+{
+	Array<TriRise> &heap = hc.riseheap;
+	assert(heap.count);
+	TriRise e = heap.Pop();
+	if(!heap.count) return;
+	int i=0;
+	for(;;)
+	{
+		int c = i*2+1;
+		if(c>=heap.count) break;
+		if(c+1<heap.count && riseabove(heap[c+1],heap[c])) c++;
+		if(!riseabove(heap[c],e)) break;
+		heap[i] = heap[c];
+		i = c;
+	}
+	heap[i] = e;
+}
+
+Tri *extrudable(HullContext &hc,Real epsilon)
+{
+	Array<Tri*> &tris = hc.tris;
+	while(hc.riseheap.count)
+	{
+		Tri *t = tris[hc.riseheap[0].id];
+		if(!t)
+		{
+			poprise(hc); // extruded or removed since it was pushed
+			continue;
+		}
+		return (t->rise >epsilon)?t:NULL ;
+	}
+	return NULL;
+}
+
+class int4
+{
+public:
+	int x,y,z,w;
+	int4(){};
+	int4(int _x,int _y, int _z,int _w){x=_x;y=_y;z=_z;w=_w;}
+	const int& operator[](int i) const {return (&x)[i];}
+	int& operator[](int i) {return (&x)[i];}
+};
+
+
+
+bool hasVolume(real3 *verts, int p0, int p1, int p2, int p3)
+{
+	real3 result3 = cross(verts[p1]-verts[p0], verts[p2]-verts[p0]);
+	if (magnitude(result3) < VOLUME_EPSILON && magnitude(result3) > -VOLUME_EPSILON) // Almost collinear or otherwise very close to each other
+		return false;
+	Real result = dot(normalize(result3), verts[p3]-verts[p0]);
+	return (result > VOLUME_EPSILON || result < -VOLUME_EPSILON); // Returns true iff volume is significantly non-zero
+}
+
+int4 FindSimplex(HullContext &hc,real3 *verts,int verts_count,Array<int> &allow)
+{
+	real3 basis[3];
+	basis[0] = real3( 0.01f, 0.02f, 1.0f );      
+	int p0 = maxdirsterid(hc,verts,verts_count, basis[0],allow);
+	int	p1 = maxdirsterid(hc,verts,verts_count,-basis[0],allow);
+	basis[0] = verts[p0]-verts[p1];
+	if(p0==p1 || basis[0]==real3(0,0,0)) 
+		return int4(-1,-1,-1,-1);
+	basis[1] = cross(real3(     1, 0.02f, 0),basis[0]);
+	basis[2] = cross(real3(-0.02f,     1, 0),basis[0]);
+	basis[1] = normalize( (magnitude(basis[1])>magnitude(basis[2])) ? basis[1]:basis[2]);
+	int p2 = maxdirsterid(hc,verts,verts_count,basis[1],allow);
+	if(p2 == p0 || p2 == p1)
+	{
+		p2 = maxdirsterid(hc,verts,verts_count,-basis[1],allow);
+	}
+	if(p2 == p0 || p2 == p1) 
+		return int4(-1,-1,-1,-1);
+	basis[1] = verts[p2] - verts[p0];
+	basis[2] = normalize(cross(basis[1],basis[0]));
+	int p3 = maxdirsterid(hc,verts,verts_count,basis[2],allow);
+	if(p3==p0||p3==p1||p3==p2||!hasVolume(verts, p0, p1, p2, p3)) p3 = maxdirsterid(hc,verts,verts_count,-basis[2],allow);
+	if(p3==p0||p3==p1||p3==p2) 
+		return int4(-1,-1,-1,-1);
+	assert(!(p0==p1||p0==p2||p0==p3||p1==p2||p1==p3||p2==p3));
+	if(dot(verts[p3]-verts[p0],cross(verts[p1]-verts[p0],verts[p2]-verts[p0])) <0) {Swap(p2,p3);}
+	return int4(p0,p1,p2,p3);
+}
+
+// Hands the orphaned outside points out to the live triangles created since 'first'.
+// Each point goes to the first of them it is more than epsilon above, anything
+// that isn't is inside (or close enough to) the hull and is dropped for good.
+// With a tolerance it goes to the one it is highest above instead, so that the rise
+// of every triangle is what decides whether the tolerance has been met.
+// Updates vmax/rise from the points each triangle receives and queues it for extrusion.
+#if HULL_THREADS
+// With QF_PARALLEL and enough orphans, the search for each point's triangle runs on
+// the task pool and the points are then linked in the same order the serial loop uses.
+class ConflictJob
+{
+public:
+	HullContext  *hc;
+	real3        *verts;
+	Tri         **targets;
+	real3        *normals;
+	int           tcount;
+	Real          epsilon;
+	bool          bestfit;
+};
+
+static void conflicttask(void *data,int,int begin,int end)
+{
+	ConflictJob *job = (ConflictJob *) data;
+	HullContext &hc = *job->hc;
+	for(int k=begin;k<end;k++)
+	{
+		int v = hc.pending[k];
+		int  owner = -1;
+		Real worst = 0;
+		for(int j=0;j<job->tcount;j++)
+		{
+			Tri *t=job->targets[j];
+			Real d = dot(job->normals[j],job->verts[v]-job->verts[(*t)[0]]);
+			if(d>job->epsilon && (owner<0 || d>worst)) owner=j;
+			if(d>worst) worst=d;
+			if(owner>=0 && !job->bestfit) break;
+		}
+		hc.owner[k]     = owner;
+		hc.ownerrise[k] = worst;  // how far out it was
+	}
+}
+#endif
+
+static void assignconflicts(HullContext &hc,real3 *verts,int first,Real epsilon,const HullBits &isextreme)
+{
+	Array<Tri*> &tris = hc.tris;
+	Array<int>  &next = hc.conflictnext;
+	Array<Tri*> &targets = hc.targets;
+	Array<real3> &normals = hc.normals;
+	targets.count = 0;
+	normals.count = 0;
+	bool bestfit = (hc.stoprise>epsilon);
+	int i,j;
+	for(j=first;j<tris.count;j++)
+	{
+		Tri *t=tris[j];
+		if(!t) continue;
+		targets.Add(t);
+		normals.Add(TriNormal(verts[(*t)[0]],verts[(*t)[1]],verts[(*t)[2]]));
+	}
+#if HULL_THREADS
+	if(hc.threads>1 && targets.count)
+	{
+		hc.pending.count=0;
+		for(i=0;i<hc.orphans.count;i++)
+		{
+			for(int v=hc.orphans[i];v>=0;v=next[v])
+			{
+				if(!isextreme[v]) hc.pending.Add(v);
+			}
+		}
+		int tasks = Min(hc.threads*PARALLEL_TASKS,hc.pending.count/(PARALLEL_GRAIN/8));
+		if(tasks>1)
+		{
+			hc.owner.count = hc.ownerrise.count = 0;
+			hc.owner.Resize(hc.pending.count);
+			hc.ownerrise.Resize(hc.pending.count);
+			ConflictJob job;
+			job.hc      = &hc;
+			job.verts   = verts;
+			job.targets = targets.element;
+			job.normals = normals.element;
+			job.tcount  = targets.count;
+			job.epsilon = epsilon;
+			job.bestfit = bestfit;
+			HullTaskPool::Get().ParallelFor(hc.pending.count,tasks,conflicttask,&job);
+			for(int k=0;k<hc.pending.count;k++)
+			{
+				if(hc.owner[k]<0) continue;
+				int v  = hc.pending[k];
+				Tri *t = targets[hc.owner[k]];
+				Real d = hc.ownerrise[k];
+				next[v] = t->conflicts;
+				t->conflicts = v;
+				if(t->vmax<0 || d>t->rise)
+				{
+					t->vmax = v;
+					t->rise = d;
+				}
+			}
+			hc.orphans.count=0;
+		}
+	}
+#endif
+	for(i=0;i<hc.orphans.count;i++)
+	{
+		int v=hc.orphans[i];
+		while(v>=0)
+		{
+			int vnext = next[v];
+			if(!isextreme[v])
+			{
+				int  owner = -1;
+				Real worst = 0;
+				for(j=0;j<targets.count;j++)
+				{
+					Tri *t=targets[j];
+					Real d = dot(normals[j],verts[v]-verts[(*t)[0]]);
+					if(d>epsilon && (owner<0 || d>worst)) owner=j;
+					if(d>worst) worst=d;
+					if(owner>=0 && !bestfit) break;
+				}
+				if(owner>=0)
+				{
+					Tri *t=targets[owner];
+					next[v] = t->conflicts;
+					t->conflicts = v;
+					if(t->vmax<0 || worst>t->rise)
+					{
+						t->vmax = v;
+						t->rise = worst;
+					}
+				}
+			}
+			v = vnext;
+		}
+	}
+	hc.orphans.count=0;
+	for(j=0;j<targets.count;j++)
+	{
+		if(targets[j]->vmax>=0) pushrise(hc,targets[j]);
+	}
+}
+
+static int expandhull(HullContext &hc,real3 *verts,int verts_count,int vlimit,Real epsilon,HullBits &isextreme,Array<int> &allow);
+
+// The next triangle to extrude.  With a tolerance and conflict lists, a point only knows
+// how high it is above the triangle it was handed to and can be further out of another,
+// so before giving up everything left in the lists is handed out again over all of them.
+static Tri *nextextrudable(HullContext &hc,real3 *verts,Real epsilon,Real stop,const HullBits &isextreme)
+{
+	Tri *te = extrudable(hc,stop);
+	if(te || !hc.conflictlists || stop<=epsilon) return te;
+	hc.orphans.count=0;
+	for(int j=0;j<hc.tris.count;j++)
+	{
+		Tri *t=hc.tris[j];
+		if(!t) continue;
+		if(t->conflicts>=0) hc.orphans.Add(t->conflicts);
+		t->conflicts = -1;
+		t->vmax      = -1;
+	}
+	if(!hc.orphans.count) return NULL;
+	hc.riseheap.count=0;
+	assignconflicts(hc,verts,0,epsilon,isextreme);
+	return extrudable(hc,stop);
+}
+
+#define ERRORCELL_POINTS 32  // about how many points hullerror puts in each cell
+
+// Sorts the points into a grid of cells and keeps the box of every cell that has any, for
+// hullerror.  Built once per calchullgen, the first time it is needed.
+static void buildcells(HullContext &hc,real3 *verts,int verts_count)
+{
+	int i;
+	real3 bmin(verts[0]),bmax(verts[0]);
+	for(i=1;i<verts_count;i++)
+	{
+		bmin = VectorMin(bmin,verts[i]);
+		bmax = VectorMax(bmax,verts[i]);
+	}
+	int g=1;
+	while(g<64 && (g+1)*(g+1)*(g+1)*ERRORCELL_POINTS<=verts_count) g++;
+	real3 ext = bmax-bmin;
+	real3 scale(ext.x>0 ? g/ext.x : 0,ext.y>0 ? g/ext.y : 0,ext.z>0 ? g/ext.z : 0);
+	Array<int> &cell  = hc.pending;  // scratch, the cell of each point
+	Array<int> &start = hc.owner;    // ... and where each cell starts in cellpoints
+	cell.count = 0;
+	cell.Resize(verts_count);
+	start.count = 0;
+	start.Resize(g*g*g+1);
+	for(i=0;i<=g*g*g;i++) start[i]=0;
+	for(i=0;i<verts_count;i++)
+	{
+		real3 c = cmul(verts[i]-bmin,scale);
+		int x = Min((int)c.x,g-1),y = Min((int)c.y,g-1),z = Min((int)c.z,g-1);
+		cell[i] = (z*g+y)*g+x;
+		start[cell[i]+1]++;
+	}
+	hc.cells.count = 0;
+	hc.cellbounds.count = 0;
+	for(i=0;i<g*g*g;i++)
+	{
+		if(start[i+1]) hc.cells.Add(start[i]);
+		start[i+1] += start[i];
+	}
+	hc.cells.Add(verts_count);
+	hc.cellpoints.count = 0;
+	hc.cellpoints.Resize(verts_count);
+	for(i=0;i<verts_count;i++) hc.cellpoints[start[cell[i]]++] = verts[i];
+	for(i=0;i+1<hc.cells.count;i++)
+	{
+		real3 cmin(hc.cellpoints[hc.cells[i]]),cmax(cmin);
+		for(int k=hc.cells[i]+1;k<hc.cells[i+1];k++)
+		{
+			cmin = VectorMin(cmin,hc.cellpoints[k]);
+			cmax = VectorMax(cmax,hc.cellpoints[k]);
+		}
+		hc.cellbounds.Add((cmin+cmax)*0.5f);
+		hc.cellbounds.Add((cmax-cmin)*0.5f);
+	}
+	cell.count = start.count = 0;
+}
+
+// The furthest any point is above the planes of the triangles in [begin,end), or e if
+// none is further.  Cells whose box stays below a plane are skipped.
+static Real cellerror(const HullContext &hc,const real3 *verts,int begin,int end,Real e)
+{
+	for(int j=begin;j<end;j++)
+	{
+		const Tri *t = hc.tris[j];
+		if(!t) continue;
+		const real3 &v0 = verts[(*t)[0]];
+		real3 n = TriNormal(v0,verts[(*t)[1]],verts[(*t)[2]]);
+		real3 a(fabs(n.x),fabs(n.y),fabs(n.z));
+		Real  d = dot(n,v0);
+		for(int i=0;i+1<hc.cells.count;i++)
+		{
+			if(dot(n,hc.cellbounds[2*i])+dot(a,hc.cellbounds[2*i+1])<=d+e) continue;
+			Real top = d+e;
+			for(int k=hc.cells[i];k<hc.cells[i+1];k++) top = Max(top,dot(n,hc.cellpoints[k]));
+			e = Max(e,top-d);
+		}
+	}
+	return e;
+}
+
+#if HULL_THREADS
+class CellErrorJob
+{
+public:
+	enum { MAXTASKS = 256 };
+	const HullContext *hc;
+	const real3       *verts;
+	Real               e[MAXTASKS];
+};
+
+static void cellerrortask(void *data,int task,int begin,int end)
+{
+	CellErrorJob *job = (CellErrorJob *) data;
+	job->e[task] = cellerror(*job->hc,job->verts,begin,end,0);
+}
+#endif
+
+// How far outside the plane of one of the current triangles the furthest point is.  The
+// rises the build keeps only say how far a point was above the triangles it was tested
+// against at the time, which later triangles can be further below, so every point is
+// measured again here.  With QF_PARALLEL the triangles are shared out over the task pool.
+static Real hullerror(HullContext &hc,real3 *verts,int verts_count)
+{
+	if(!hc.cells.count) buildcells(hc,verts,verts_count);
+#if HULL_THREADS
+	int tasks = Min(hc.threads*PARALLEL_TASKS,hc.tris.count/256);
+	if(tasks > CellErrorJob::MAXTASKS) tasks = CellErrorJob::MAXTASKS;
+	if(hc.threads>1 && tasks>1)
+	{
+		CellErrorJob job;
+		job.hc    = &hc;
+		job.verts = verts;
+		HullTaskPool::Get().ParallelFor(hc.tris.count,tasks,cellerrortask,&job);
+		Real e = 0;
+		for(int i=0;i<tasks;i++) e = Max(e,job.e[i]);
+		return e;
+	}
+#endif
+	return cellerror(hc,verts,0,hc.tris.count,0);
+}
+
+// Copies the hull as it stands for every LOD budget it has now reached, or for all of
+// those still missing once the hull is finished.  The triangles come out in the order
+// calchull would list them, so each copy is exactly the hull that budget on its own
+// would have given.
+static void takesnapshots(HullContext &hc,real3 *verts,int verts_count,bool finished)
+{
+	for(int i=0;i<hc.lodbudgets.count;i++)
+	{
+		if(hc.lodstart[i]>=0) continue;
+		if(!finished && (hc.lodbudgets[i]==0 || hc.lodbudgets[i]>hc.hullverts)) continue;
+		hc.lodstart[i] = hc.lodtris.count;
+		for(int j=0;j<hc.tris.count;j++) if(hc.tris[j])
+		{
+			for(int k=0;k<3;k++) hc.lodtris.Add((*hc.tris[j])[k]);
+		}
+		hc.lodcount[i] = hc.lodtris.count-hc.lodstart[i];
+		hc.loderror[i] = hullerror(hc,verts,verts_count);
+	}
+}
+
+// Warm start: hands every point not on the hull yet to the triangle that the ray from
+// hc.center through it leaves by.  A point that isn't outside that triangle, or one next
+// to it, is inside the hull, so each point costs a short walk across the surface rather
+// than a test against every triangle.  Walks start from wherever the last one in a
+// similar direction ended, which is usually the right triangle or next to it.
+#define LOCATE_CELLS 16  // direction cells per side of each cube face
+
+static int locatecell(const real3 &d)
+{
+	int axis = (fabs(d.x)>fabs(d.y)) ? ((fabs(d.x)>fabs(d.z))?0:2) : ((fabs(d.y)>fabs(d.z))?1:2);
+	Real m = fabs(d[axis]);
+	if(m==0) return 0;
+	int u = (int)((d[(axis+1)%3]/m+1)*(0.5f*LOCATE_CELLS));
+	int v = (int)((d[(axis+2)%3]/m+1)*(0.5f*LOCATE_CELLS));
+	u = Min(Max(u,0),LOCATE_CELLS-1);
+	v = Min(Max(v,0),LOCATE_CELLS-1);
+	return ((axis*2+(d[axis]<0))*LOCATE_CELLS+u)*LOCATE_CELLS+v;
+}
+
+static void locateconflicts(HullContext &hc,real3 *verts,int verts_count,Real epsilon,const HullBits &isextreme)
+{
+	Array<Tri*> &tris = hc.tris;
+	Array<int>  &next = hc.conflictnext;
+	const real3 &center = hc.center;
+	int i,j;
+	Array<real3> &normals = hc.normals;  // per triangle id, its normal
+	Array<real3> &edges   = hc.edges;    // ... and the planes through center and each of its edges
+	normals.count = 0;
+	edges.count   = 0;
+	Tri *start=NULL;
+	for(j=0;j<tris.count;j++)
+	{
+		Tri *t=tris[j];
+		normals.Add(t ? TriNormal(verts[(*t)[0]],verts[(*t)[1]],verts[(*t)[2]]) : real3(0,0,0));
+		for(i=0;i<3;i++) edges.Add(t ? cross(verts[(*t)[i]]-center,verts[(*t)[(i+1)%3]]-center) : real3(0,0,0));
+		if(t && !start) start=t;
+	}
+	Tri *cells[6*LOCATE_CELLS*LOCATE_CELLS];
+	for(j=0;j<6*LOCATE_CELLS*LOCATE_CELLS;j++) cells[j]=start;
+
+	for(int v=0;v<verts_count;v++)
+	{
+		if(isextreme[v]) continue;
+		real3 d = verts[v]-center;
+		int cell = locatecell(d);
+		Tri *t = cells[cell];
+		int steps;
+		for(steps=0;steps<tris.count;steps++)
+		{
+			// step over the first edge the ray passes outside of
+			const real3 *e = &edges[t->id*3];
+			for(i=0;i<3;i++)
+			{
+				if(dot(d,e[i])<0) break;
+			}
+			if(i==3) break;
+			t = tris[t->n[(i+2)%3]];
+		}
+		cells[cell] = t;
+		Tri *owner=NULL;
+		Real rise=0;
+		for(i=-1;i<3 && !owner;i++)
+		{
+			Tri *c = (i<0) ? t : tris[t->n[i]];
+			rise = dot(normals[c->id],verts[v]-verts[(*c)[0]]);
+			if(rise>epsilon) owner=c;
+		}
+		if(!owner && steps==tris.count)
+		{
+			// the walk went round in circles, fall back on trying them all
+			for(j=0;j<tris.count && !owner;j++)
+			{
+				Tri *c=tris[j];
+				if(!c) continue;
+				rise = dot(normals[j],verts[v]-verts[(*c)[0]]);
+				if(rise>epsilon) owner=c;
+			}
+		}
+		if(!owner) continue;
+		next[v] = owner->conflicts;
+		owner->conflicts = v;
+		if(owner->vmax<0 || rise>owner->rise)
+		{
+			owner->vmax = v;
+			owner->rise = rise;
+		}
+	}
+	for(j=0;j<tris.count;j++)
+	{
+		if(tris[j] && tris[j]->vmax>=0) pushrise(hc,tris[j]);
+	}
+}
+
+int calchullgen(HullContext &hc,real3 *verts,int verts_count, int vlimit) 
+{
+	Array<Tri*> &tris = hc.tris;
+	if(verts_count <4) return 0;
+	if(vlimit==0) vlimit=1000000000;
+	int j;
+	real3 bmin(*verts),bmax(*verts);
+	HullBits   &isextreme = hc.isextreme;
+	Array<int> &allow     = hc.allow;
+	isextreme.Clear();
+	isextreme.Resize(verts_count);
+	allow.Resize(verts_count);
+	for(j=0;j<verts_count;j++) 
+	{
+		allow[j] = 1;
+		bmin = VectorMin(bmin,verts[j]);
+		bmax = VectorMax(bmax,verts[j]);
+	}
+	Real epsilon = magnitude(bmax-bmin) * 0.001f;
+	hc.stoprise = Max(hc.tolerance,hc.relativetolerance*magnitude(bmax-bmin));
+	hc.cells.count = 0;
+	hc.riseheap.count=0;
+
+	// with hints, the simplex and the first hull come from the hinted points alone
+	int4 p(-1,-1,-1,-1);
+	int  hinthead=-1;
+	if(hc.hints.count>=4)
+	{
+		for(j=0;j<verts_count;j++) allow[j]=0;
+		for(j=0;j<hc.hints.count;j++)
+		{
+			assert(hc.hints[j]>=0 && hc.hints[j]<verts_count);
+			allow[hc.hints[j]]=1;
+		}
+		if(hc.conflictlists)
+		{
+			hc.conflictnext.Resize(verts_count);
+			for(j=verts_count-1;j>=0;j--)
+			{
+				if(!allow[j]) continue;
+				hc.conflictnext[j]=hinthead;
+				hinthead=j;
+			}
+		}
+		p = FindSimplex(hc,verts,verts_count,allow);
+		// without conflict lists allow keeps to the hints until their hull is done
+		if(hc.conflictlists || p.x==-1) for(j=0;j<verts_count;j++) allow[j]=1;
+	}
+	bool seeded = (p.x!=-1);
+	if(!seeded) p = FindSimplex(hc,verts,verts_count,allow);
+	if(p.x==-1) return 0; // simplex failed
+
+
+
+	hc.center = (verts[p[0]]+verts[p[1]]+verts[p[2]]+verts[p[3]]) /4.0f;  // a valid interior point
+	Tri *t0 = allocatetri(hc,p[2],p[3],p[1]); t0->n=int3(2,3,1);
+	Tri *t1 = allocatetri(hc,p[3],p[2],p[0]); t1->n=int3(3,2,0);
+	Tri *t2 = allocatetri(hc,p[0],p[1],p[3]); t2->n=int3(0,1,3);
+	Tri *t3 = allocatetri(hc,p[1],p[0],p[2]); t3->n=int3(1,0,2);
+	for(j=0;j<4;j++) isextreme.Set(p[j]);
+	hc.hullverts=4;
+	checkit(hc,t0);checkit(hc,t1);checkit(hc,t2);checkit(hc,t3);
+
+	vlimit-=4;
+	if(seeded && hc.conflictlists)
+	{
+		// hull the hints, then check the rest of the cloud against that and repair it
+		hc.orphans.count=0;
+		hc.orphans.Add(hinthead);
+		assignconflicts(hc,verts,0,epsilon,isextreme);
+		vlimit = expandhull(hc,verts,verts_count,vlimit,epsilon,isextreme,allow);
+		locateconflicts(hc,verts,verts_count,epsilon,isextreme);
+	}
+	else if(hc.conflictlists)
+	{
+		// start with every point in one orphaned list and let the simplex claim them
+		hc.conflictnext.Resize(verts_count);
+		hc.orphans.count=0;
+		int head=-1;
+		for(j=verts_count-1;j>=0;j--)
+		{
+			hc.conflictnext[j]=head;
+			head=j;
+		}
+		hc.orphans.Add(head);
+		assignconflicts(hc,verts,0,epsilon,isextreme);
+	}
+	else for(j=0;j<tris.count;j++)
+	{
+		Tri *t=tris[j];
+		assert(t);
+		assert(t->vmax<0);
+		real3 n=TriNormal(verts[(*t)[0]],verts[(*t)[1]],verts[(*t)[2]]);
+		t->vmax = maxdirsterid(hc,verts,verts_count,n,allow);
+		t->rise = dot(n,verts[t->vmax]-verts[(*t)[0]]);
+		pushrise(hc,t);
+	}
+	if(seeded && !hc.conflictlists)
+	{
+		// hull the hints, then let the rest of the cloud in and look again from every face
+		vlimit = expandhull(hc,verts,verts_count,vlimit,epsilon,isextreme,allow);
+		for(j=0;j<verts_count;j++) if(!allow[j]) allow[j]=1;
+		hc.riseheap.count=0;
+		for(j=0;j<tris.count;j++)
+		{
+			Tri *t=tris[j];
+			if(!t) continue;
+			real3 n=TriNormal(verts[(*t)[0]],verts[(*t)[1]],verts[(*t)[2]]);
+			t->vmax = maxdirsterid(hc,verts,verts_count,n,allow);
+			if(isextreme[t->vmax])
+			{
+				t->vmax=-1; // nothing outside this face
+			}
+			else
+			{
+				t->rise = dot(n,verts[t->vmax]-verts[(*t)[0]]);
+				pushrise(hc,t);
+			}
+		}
+	}
+	expandhull(hc,verts,verts_count,vlimit,epsilon,isextreme,allow);
+	hc.error = hullerror(hc,verts,verts_count);
+	if(hc.lodbudgets.count) takesnapshots(hc,verts,verts_count,true);
+	return 1;
+}
+
+// Adds the vertex of the tallest extrudable triangle, one at a time, until nothing is
+// more than epsilon outside, vlimit more vertices have been added or the build has
+// expired.  Returns what is left of vlimit.
+static int expandhull(HullContext &hc,real3 *verts,int verts_count,int vlimit,Real epsilon,HullBits &isextreme,Array<int> &allow)
+{
+	Array<Tri*> &tris = hc.tris;
+	const real3 &center = hc.center;
+	int j;
+	Tri *te;
+	if(hc.lodbudgets.count) takesnapshots(hc,verts,verts_count,false);
+	Real stop = Max(epsilon,hc.stoprise);  // a tolerance can only end the expansion sooner
+	while(vlimit >0 && (te=nextextrudable(hc,verts,epsilon,stop,isextreme)) && !hc.Expired())
+	{
+		int3 ti=*te;
+		int v=te->vmax;
+		assert(!isextreme[v]);  // wtf we've already done this vertex
+		isextreme.Set(v);
+		hc.hullverts++;
+		//if(v==p0 || v==p1 || v==p2 || v==p3) continue; // done these already
+		j=tris.count;
+		int newstart=j;
+		if(hc.conflictlists)
+		{
+			// the faces that can see v form a connected patch around te, so flood out from it
+			// rather than testing every triangle.
+			Array<Tri*> &visible = hc.visible;
+			visible.count=0;
+			te->visit=v;
+			visible.Add(te);
+			for(int k=0;k<visible.count;k++)
+			{
+				for(int i=0;i<3;i++)
+				{
+					Tri *nb = tris[visible[k]->n[i]];
+					if(nb->visit==v) continue;
+					nb->visit=v;
+					if(cansee(hc,verts,*nb,verts[v],epsilon)) visible.Add(nb);
+				}
+			}
+			for(int k=0;k<visible.count;k++)
+			{
+				extrude(hc,visible[k],v);
+			}
+		}
+		else while(j--) {
+			if(!tris[j]) continue;
+			int3 t=*tris[j];
+			if(cansee(hc,verts,t,verts[v],epsilon))
+			{
+				extrude(hc,tris[j],v);
+			}
+		}
+		// now check for those degenerate cases where we have a flipped triangle or a really skinny triangle.
+		// With exact tests there are none: every new triangle joins v to an edge between a face
+		// v is strictly above and one it is not, so it can neither flip nor collapse.
+		j = hc.exact ? 0 : tris.count;
+		while(j--)
+		{
+			if(!tris[j]) continue;
+			if(!hasvert(*tris[j],v)) break;
+			int3 nt=*tris[j];
+			if(above(verts,nt,center,0.01f*epsilon)  || magnitude(cross(verts[nt[1]]-verts[nt[0]],verts[nt[2]]-verts[nt[1]]))< epsilon*epsilon*0.1f )
+			{
+				Tri *nb = tris[tris[j]->n[0]];
+				assert(nb);assert(!hasvert(*nb,v));assert(nb->id<j);
+				extrude(hc,nb,v);
+				j=tris.count;
+			}
+		}
+		if(hc.conflictlists)
+		{
+			assignconflicts(hc,verts,newstart,epsilon,isextreme);
+		}
+		else for(j=tris.count;j--;)
+		{
+			Tri *t=tris[j];
+			if(!t) continue;
+			if(t->vmax>=0) break;
+			real3 n=TriNormal(verts[(*t)[0]],verts[(*t)[1]],verts[(*t)[2]]);
+			t->vmax = maxdirsterid(hc,verts,verts_count,n,allow);
+			if(isextreme[t->vmax]) 
+			{
+				t->vmax=-1; // already done that vertex - algorithm needs to be able to terminate.
+			}
+			else
+			{
+				t->rise = dot(n,verts[t->vmax]-verts[(*t)[0]]);
+				pushrise(hc,t);
+			}
+		}
+		vlimit --;
+		if(hc.lodbudgets.count) takesnapshots(hc,verts,verts_count,false);
+	}
+	return vlimit;
+}
+
+int calchull(HullContext &hc,real3 *verts,int verts_count, int *&tris_out, int &tris_count,int vlimit) 
+{
+	Array<Tri*> &tris = hc.tris;
+	int rc=calchullgen(hc,verts,verts_count,  vlimit) ;
+	if(!rc) return 0;
+	Array<int> &ts = hc.hullindices; // stays with hc, tris_out is good until its next build
+	ts.count = 0;
+	for(int i=0;i<tris.count;i++)if(tris[i])
+	{
+		for(int j=0;j<3;j++)ts.Add((*tris[i])[j]);
+	}
+	tris_count = ts.count/3;
+	tris_out   = ts.element;
+	releasetris(hc);
+	return 1;
+}
+
+static Real area2(const real3 &v0,const real3 &v1,const real3 &v2)
+{
+	real3 cp = cross(v0-v1,v2-v0);
+	return dot(cp,cp);
+}
+int calchullpbev(HullContext &hc,real3 *verts,int verts_count,int vlimit, Array<Plane> &planes,Real bevangle) 
+{
+	Array<Tri*> &tris = hc.tris;
+	int i,j;
+	Array<Plane> bplanes;
+	planes.count=0;
+	int rc = calchullgen(hc,verts,verts_count,vlimit);
+	if(!rc) return 0;
+	Real maxdot_minang = cos(DEG2RAD*hc.minadjangle);
+	for(i=0;i<tris.count;i++)if(tris[i])
+	{
+		Plane p;
+		Tri *t = tris[i];
+		p.normal = TriNormal(verts[(*t)[0]],verts[(*t)[1]],verts[(*t)[2]]);
+		p.dist   = -dot(p.normal, verts[(*t)[0]]);
+		for(j=0;j<3;j++)
+		{
+			if(t->n[j]<t->id) continue;
+			Tri *s = tris[t->n[j]];
+			REAL3 snormal = TriNormal(verts[(*s)[0]],verts[(*s)[1]],verts[(*s)[2]]);
+			if(dot(snormal,p.normal)>=cos(bevangle*DEG2RAD)) continue;
+			REAL3 e = verts[(*t)[(j+2)%3]] - verts[(*t)[(j+1)%3]];
+			REAL3 n = (e!=REAL3(0,0,0))? cross(snormal,e)+cross(e,p.normal) : snormal+p.normal;
+			assert(n!=REAL3(0,0,0));
+			if(n==REAL3(0,0,0)) return 0;  
+			n=normalize(n);
+			bplanes.Add(Plane(n,-dot(n,verts[maxdir(verts,verts_count,n)])));
+		}
+	}
+	for(i=0;i<tris.count;i++)if(tris[i])for(j=i+1;j<tris.count;j++)if(tris[i] && tris[j])
+	{
+		Tri *ti = tris[i];
+		Tri *tj = tris[j];
+		REAL3 ni = TriNormal(verts[(*ti)[0]],verts[(*ti)[1]],verts[(*ti)[2]]);
+		REAL3 nj = TriNormal(verts[(*tj)[0]],verts[(*tj)[1]],verts[(*tj)[2]]);
+		if(dot(ni,nj)>maxdot_minang)
+		{
+			// somebody has to die, keep the biggest triangle
+			if( area2(verts[(*ti)[0]],verts[(*ti)[1]],verts[(*ti)[2]]) < area2(verts[(*tj)[0]],verts[(*tj)[1]],verts[(*tj)[2]]))
+			{
+				deallocatetri(hc,tris[i]);
+			}
+			else
+			{
+				deallocatetri(hc,tris[j]);
+			}
+		}
+	}
+	for(i=0;i<tris.count;i++)if(tris[i])
+	{
+		Plane p;
+		Tri *t = tris[i];
+		p.normal = TriNormal(verts[(*t)[0]],verts[(*t)[1]],verts[(*t)[2]]);
+		p.dist   = -dot(p.normal, verts[(*t)[0]]);
+		planes.Add(p);
+	}
+	for(i=0;i<bplanes.count;i++)
+	{
+		for(j=0;j<planes.count;j++)
+		{
+			if(dot(bplanes[i].normal,planes[j].normal)>maxdot_minang) break;
+		}
+		if(j==planes.count)
+		{
+			planes.Add(bplanes[i]);
+		}
+	}
+	releasetris(hc);
+	return 1;
+}
+
+static int overhull(HullContext &hc,Plane *planes,int planes_count,real3 *verts, int verts_count,int maxplanes, 
+			 real3 *&verts_out, int &verts_count_out,  int *&faces_out, int &faces_count_out ,Real inflate)
+{
+	int i,j;
+	if(verts_count <4) return NULL;
+	maxplanes = Min(maxplanes,planes_count);
+	real3 bmin(verts[0]),bmax(verts[0]);
+	for(i=0;i<verts_count;i++) 
+	{
+		bmin = VectorMin(bmin,verts[i]);
+		bmax = VectorMax(bmax,verts[i]);
+	}
+	Real diameter = magnitude(bmax-bmin);
+//	inflate *=diameter;   // RELATIVE INFLATION
+	bmin -= real3(inflate*2.5f,inflate*2.5f,inflate*2.5f); 
+	bmax += real3(inflate*2.5f,inflate*2.5f,inflate*2.5f); 
+	// 2 is from the formula:
+	// D = d*|n1+n2|/(1-n1 dot n2), where d is "inflate" and
+	// n1 and n2 are the normals of two planes at bevelAngle to each other
+	// for 120 degrees, D is 2d
+
+	//bmin -= real3(inflate,inflate,inflate);
+	//bmax += real3(inflate,inflate,inflate);
+	for(i=0;i<planes_count;i++)
+	{
+		planes[i].dist -= inflate;
+	}
+	real3 emin = bmin; // VectorMin(bmin,real3(0,0,0));
+	real3 emax = bmax; // VectorMax(bmax,real3(0,0,0));
+	Real epsilon  = 0.01f; // size of object is taken into account within candidate plane function.  Used to multiply here by magnitude(emax-emin) 
+	hc.planetestepsilon = magnitude(emax-emin) * PAPERWIDTH;
+	// todo: add bounding cube planes to force bevel. or try instead not adding the diameter expansion ??? must think.
+	// ConvexH *convex = ConvexHMakeCube(bmin - real3(diameter,diameter,diameter),bmax+real3(diameter,diameter,diameter));
+	Real maxdot_minang = cos(DEG2RAD*hc.minadjangle);
+	for(j=0;j<6;j++)
+	{
+		real3 n(0,0,0);
+		n[j/2] = (j%2)? 1.0f : -1.0f;
+		for(i=0;i<planes_count;i++)
+		{
+			if(dot(n,planes[i].normal)> maxdot_minang)
+			{
+				(*((j%2)?&bmax:&bmin)) += n * (diameter*0.5f);
+				break;
+			}
+		}
+	}
+	ConvexH *c = ConvexHMakeCube(REAL3(bmin),REAL3(bmax)); 
+	int k;
+	while(maxplanes-- && !hc.Expired() && (k=candidateplane(hc,planes,planes_count,c,epsilon))>=0)  // every crop so far still holds all the points
+	{
+		ConvexH *tmp = c;
+		c = ConvexHCrop(hc,*tmp,planes[k]);
+		if(c==NULL) {c=tmp; break;} // might want to debug this case better!!!
+		if(!AssertIntact(hc,*c)) {c=tmp; break;} // might want to debug this case better too!!!
+		delete tmp;
+	}
+
+	assert(AssertIntact(hc,*c));
+	//return c;
+	faces_out = (int*)NX_ALLOC(sizeof(int)*(1+c->facets.count+c->edges.count), CONVEX_TEMP);     // new int[1+c->facets.count+c->edges.count];
+	faces_count_out=0;
+	i=0;
+	faces_out[faces_count_out++]=-1;
+	k=0;
+	while(i<c->edges.count)
+	{
+		j=1;
+		while(j+i<c->edges.count && c->edges[i].p==c->edges[i+j].p) { j++; }
+		faces_out[faces_count_out++]=j;
+		while(j--)
+		{
+			faces_out[faces_count_out++] = c->edges[i].v;
+			i++;
+		}
+		k++;
+	}
+	faces_out[0]=k; // number of faces.
+	assert(k==c->facets.count);
+	assert(faces_count_out == 1+c->facets.count+c->edges.count);
+	verts_out = c->vertices.element; // new real3[c->vertices.count];
+	verts_count_out = c->vertices.count;
+	for(i=0;i<c->vertices.count;i++)
+	{
+		verts_out[i] = real3(c->vertices[i]);
+	}
+	c->vertices.count=c->vertices.array_size=0;	c->vertices.element=NULL;
+	delete c;
+	return 1;
+}
+
+static int overhullv(HullContext &hc,real3 *verts, int verts_count,int maxplanes,
+			 real3 *&verts_out, int &verts_count_out,  int *&faces_out, int &faces_count_out ,Real inflate,Real bevangle,int vlimit)
+{
+	if(!verts_count) return 0;
+	Array<Plane> planes;
+	int rc=calchullpbev(hc,verts,verts_count,vlimit,planes,bevangle) ;
+	if(!rc) return 0;
+	return overhull(hc,planes.element,planes.count,verts,verts_count,maxplanes,verts_out,verts_count_out,faces_out,faces_count_out,inflate);
+}
+
+
+//*****************************************************
+//*****************************************************
+
+
+bool ComputeHull(HullContext &hc,unsigned int vcount,const Real *vertices,PHullResult &result,unsigned int vlimit,Real inflate)
+{
+
+	int index_count;
+	int *faces;
+	real3 *verts_out;
+	int     verts_count_out;
+
+	if(inflate==0.0f)
+	{
+		int  *tris_out;
+		int    tris_count;
+		int ret = calchull( hc, (real3 *) vertices, (int) vcount, tris_out, tris_count, vlimit );
+		if(!ret) return false;
+		result.mIndexCount = (unsigned int) (tris_count*3);
+		result.mFaceCount  = (unsigned int) tris_count;
+		result.mVertices   = (Real*) vertices;
+		result.mVcount     = (unsigned int) vcount;
+		result.mIndices    = (unsigned int *) tris_out;
+		return true;
+	}
+
+	int ret = overhullv(hc,(real3*)vertices,vcount,35,verts_out,verts_count_out,faces,index_count,inflate,120.0f,vlimit);
+	if(!ret) {
+		releasetris(hc); // calchullpbev can bail out with triangles still allocated
+		return false;
+	}
+
+	Array<int3> tris;
+	int n=faces[0];
+	int k=1;
+	for(int i=0;i<n;i++)
+	{
+		int pn = faces[k++];
+		for(int j=2;j<pn;j++) tris.Add(int3(faces[k],faces[k+j-1],faces[k+j]));
+		k+=pn;
+	}
+	assert(tris.count == index_count-1-(n*3));
+	NX_FREE(faces);	// PT: I added that. Is it ok ?
+
+	result.mIndexCount = (unsigned int) (tris.count*3);
+	result.mFaceCount  = (unsigned int) tris.count;
+	result.mVertices   = (Real*) verts_out;
+	result.mVcount     = (unsigned int) verts_count_out;
+	result.mIndices    = (unsigned int *) tris.element;
+	tris.element=NULL; tris.count = tris.array_size=0;
+
+	return true;
+}
+
+
+// Akl-Toussaint interior point filter (QF_PREFILTER).  The points furthest along
+// the 26 k-DOP directions span a polytope that lies inside the hull, so nothing
+// strictly inside it can be a hull vertex or decide which point is extreme in any
+// direction.  Those points are dropped before the hull is built, which gives the
+// same hull from far fewer points when most of the input is interior.
+
+#define PREFILTER_MIN 64  // below this the filter costs more than it saves
+
+class PrefilterJob
+{
+public:
+	const real3 *verts;
+	const Plane *planes;
+	int          pcount;
+	Real         margin;
+	char        *keep;
+};
+
+static void prefiltertask(void *data,int,int begin,int end)
+{
+	PrefilterJob *job = (PrefilterJob *) data;
+	for(int i=begin;i<end;i++)
+	{
+		const real3 &v = job->verts[i];
+		char keep = 0;
+		for(int j=0;j<job->pcount;j++)
+		{
+			if(dot(job->planes[j].normal,v)+job->planes[j].dist >= -job->margin)
+			{
+				keep = 1;
+				break;
+			}
+		}
+		job->keep[i] = keep;
+	}
+}
+
+// Compacts 'vertices', and 'sources' with them, in place, keeping the survivors in their
+// original order, and returns how many are left.
+static unsigned int prefilter(HullScratch &scratch,Real *vertices,unsigned int *sources,unsigned int vcount)
+{
+	if(vcount < PREFILTER_MIN) return vcount;
+	HullContext &hc = scratch.hc;
+	real3 *verts = (real3 *) vertices;
+	Array<int>   &extreme = scratch.extreme;
+	Array<real3> &corners = scratch.extremes;
+	extreme.count = 0;
+	corners.count = 0;
+	int x,y,z,i;
+	for(x=-1;x<=1;x++) for(y=-1;y<=1;y++) for(z=-1;z<=1;z++)
+	{
+		if(!x && !y && !z) continue;
+#if HULL_THREADS
+		int m = (hc.threads>1) ? maxdirparallel(hc.threads,verts,vcount,real3((Real)x,(Real)y,(Real)z),NULL) : maxdir(verts,vcount,real3((Real)x,(Real)y,(Real)z));
+#else
+		int m = maxdir(verts,vcount,real3((Real)x,(Real)y,(Real)z));
+#endif
+		if(extreme.Contains(m)) continue;
+		extreme.Add(m);
+		corners.Add(verts[m]);
+	}
+
+	// hull the corners with a context of their own, the caller's is about to be used for the real thing
+	HullContext &pc = scratch.corners;
+	pc.Reset();
+	int *tris;
+	int  tcount;
+	if(!calchull(pc,corners.element,corners.count,tris,tcount,0)) return vcount; // flat input, nothing is strictly inside
+
+	real3 bmin(corners[0]),bmax(corners[0]),center(0,0,0);
+	for(i=0;i<corners.count;i++)
+	{
+		bmin    = VectorMin(bmin,corners[i]);
+		bmax    = VectorMax(bmax,corners[i]);
+		center += corners[i];
+	}
+	center = center/(Real)corners.count;
+	Array<Plane> &planes = scratch.planes;
+	planes.count = 0;
+	for(i=0;i<tcount;i++)
+	{
+		const real3 &a = corners[tris[i*3+0]];
+		const real3 &b = corners[tris[i*3+1]];
+		const real3 &c = corners[tris[i*3+2]];
+		Plane p(TriNormal(a,b,c),0);
+		p.dist = -dot(p.normal,a);
+		if(dot(p.normal,center)+p.dist > 0) p = PlaneFlip(p); // keep them facing out
+		planes.Add(p);
+	}
+
+	Array<char> &keep = scratch.keep;
+	keep.Resize(vcount);
+	PrefilterJob job;
+	job.verts  = verts;
+	job.planes = planes.element;
+	job.pcount = planes.count;
+	job.margin = magnitude(bmax-bmin)*PAPERWIDTH*0.01f; // only drop points that are clearly inside
+	job.keep   = keep.element;
+#if HULL_THREADS
+	int tasks = Min(hc.threads*PARALLEL_TASKS,(int)vcount/(PARALLEL_GRAIN/8));
+	HullTaskPool::Get().ParallelFor(vcount,(hc.threads>1) ? tasks : 1,prefiltertask,&job);
+#else
+	prefiltertask(&job,0,0,vcount);
+#endif
+
+	unsigned int kept = 0;
+	for(unsigned int k=0;k<vcount;k++)
+	{
+		if(!keep[k]) continue;
+		if(k!=kept)
+		{
+			verts[kept]   = verts[k];
+			sources[kept] = sources[k];
+		}
+		kept++;
+	}
+	return kept;
+}
+
+void ReleaseHull(PHullResult &result)
+{
+NX_FREE(result.mIndices);	// PT: I added that. Is it ok ?
+NX_FREE(result.mVertices);	// PT: I added that. Is it ok ?
+	result.mVcount = 0;
+	result.mIndexCount = 0;
+	result.mIndices = 0;
+	result.mVertices = 0;
+	result.mIndices  = 0;
+}
+
+
+
+//****** HULLLIB source code
+
+
+// The arrays of a result: memory of their own that ReleaseResult frees, or with keep
+// (HullWorkspace) the output arrays of that scratch, good until its next build.
+static Real *resultvertices(HullScratch *keep,unsigned int count)
+{
+	if ( !keep ) return (Real *) NX_ALLOC( sizeof(Real)*count, CONVEX_TEMP );
+	keep->outvertices.Resize(count);
+	return keep->outvertices.element;
+}
+
+static unsigned int *resultindices(Array<unsigned int> *keep,unsigned int count)
+{
+	if ( !keep ) return (unsigned int *) NX_ALLOC( sizeof(unsigned int)*count, CONVEX_TEMP );
+	keep->Resize(count);
+	return keep->element;
+}
+
+// Copies the triangles of hr, over the ovcount vertices in vscratch, out to the caller's result
+// as triangles or as polygons depending on QF_TRIANGLES.
+static void CopyResult(unsigned int flags,const PHullResult &hr,const Real *vscratch,unsigned int ovcount,HullResultT<Real> &result,HullScratch *keep)
+{
+	Array<unsigned int> *keepindices = keep ? &keep->outindices : NULL;
+	if ( (flags & QF_TRIANGLES) ) // if he wants the results as triangle!
+	{
+		result.mPolygons          = false;
+		result.mNumOutputVertices = ovcount;
+		result.mOutputVertices    = resultvertices(keep,ovcount*3);
+		result.mNumFaces          = hr.mFaceCount;
+		result.mNumIndices        = hr.mIndexCount;
+
+		result.mIndices           = resultindices(keepindices,hr.mIndexCount);
+
+		memcpy(result.mOutputVertices, vscratch, sizeof(Real)*3*ovcount );
+
+  			if ( (flags & QF_REVERSE_ORDER) )
+		{
+
+			const unsigned int *source = hr.mIndices;
+						unsigned int *dest   = result.mIndices;
+
+			for (unsigned int i=0; i<hr.mFaceCount; i++)
+			{
+				dest[0] = source[2];
+				dest[1] = source[1];
+				dest[2] = source[0];
+				dest+=3;
+				source+=3;
+			}
+
+		}
+		else
+		{
+			memcpy(result.mIndices, hr.mIndices, sizeof(unsigned int)*hr.mIndexCount);
+		}
+	}
+	else
+	{
+		result.mPolygons          = true;
+		result.mNumOutputVertices = ovcount;
+		result.mOutputVertices    = resultvertices(keep,ovcount*3);
+		result.mNumFaces          = hr.mFaceCount;
+		result.mNumIndices        = hr.mIndexCount+hr.mFaceCount;
+		result.mIndices           = resultindices(keepindices,result.mNumIndices);
+		memcpy(result.mOutputVertices, vscratch, sizeof(Real)*3*ovcount );
+
+		if ( 1 )
+		{
+			const unsigned int *source = hr.mIndices;
+						unsigned int *dest   = result.mIndices;
+			for (unsigned int i=0; i<hr.mFaceCount; i++)
+			{
+				dest[0] = 3;
+				if ( (flags & QF_REVERSE_ORDER) )
+				{
+					dest[1] = source[2];
+					dest[2] = source[1];
+					dest[3] = source[0];
+				}
+				else
+				{
+					dest[1] = source[0];
+					dest[2] = source[1];
+					dest[3] = source[2];
+				}
+
+				dest+=4;
+				source+=3;
+			}
+		}
+	}
+}
+
+// Copies the hull in hr out to result, re-indexed so it refers only to the vertices it
+// uses, along with the input index of each of them.  With keep the result's arrays are
+// those of the scratch (see resultvertices).
+static void FinishHull(HullScratch &scratch,bool keep,unsigned int flags,PHullResult &hr,const Real *vsource,const unsigned int *sources,HullResultT<Real> &result)
+{
+	unsigned int ovcount;
+	unsigned int most = Min(hr.mVcount,hr.mIndexCount); // no more vertices than indices use
+	scratch.vscratch.Resize(most*3);
+	scratch.oindex.Resize(most);
+	Real *vscratch = scratch.vscratch.element;
+	unsigned int *oindex = scratch.oindex.element;
+	BringOutYourDead(hr.mVertices,hr.mVcount, vscratch, ovcount, hr.mIndices, hr.mIndexCount, oindex, scratch.used );
+
+	CopyResult(flags,hr,vscratch,ovcount,result,keep ? &scratch : NULL);
+	result.mTruncated = scratch.hc.truncated;
+
+	// the skin width path makes new vertices, otherwise hr is still indexing vsource
+	result.mOutputSources = resultindices(keep ? &scratch.outsources : NULL,ovcount);
+	for (unsigned int i=0; i<ovcount; i++)
+	{
+		result.mOutputSources[i] = (hr.mVertices == vsource) ? sources[oindex[i]] : HULL_NO_SOURCE;
+	}
+}
+
+// The bounding box of the input points and, for each axis, the first of the points with
+// the smallest and with the largest coordinate on it.
+class HullBounds
+{
+public:
+	Real         bmin[3];
+	Real         bmax[3];
+	unsigned int imin[3];
+	unsigned int imax[3];
+};
+
+// Everything before welding wants the bounding box of the raw input, so it is found once
+// in a sweep that takes the min/max of x, y and z together.  A point only costs a branch
+// when it moves the box, which after the first few is rare, and the extremes come out
+// the same as a scalar scan with strict compares would pick.
+typedef void (*BoundsKernel)(const char *base,unsigned int stride,unsigned int count,HullBounds &b);
+
+#if HULL_SIMD_X86
+
+static HULL_TARGET("sse2") void boundsfloatsse2(const char *base,unsigned int stride,unsigned int count,HullBounds &b)
+{
+	// x,y and z of a point without reading past its z
+	#define HULL_LOADXYZ(q) _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd((const double *)(q))),_mm_load_ss((const float *)(q)+2))
+	__m128 mn = _mm_set1_ps( FLT_MAX);
+	__m128 mx = _mm_set1_ps(-FLT_MAX);
+	unsigned int imin[3] = { 0, 0, 0 };
+	unsigned int imax[3] = { 0, 0, 0 };
+	const char *q = base;
+	for (unsigned int i=0; i<count; i++, q+=stride)
+	{
+		__m128 p = HULL_LOADXYZ(q);
+		int lt = _mm_movemask_ps(_mm_cmplt_ps(p,mn)) & 7;
+		int gt = _mm_movemask_ps(_mm_cmpgt_ps(p,mx)) & 7;
+		if ( lt | gt )
+		{
+			mn = _mm_min_ps(mn,p);
+			mx = _mm_max_ps(mx,p);
+			for (int j=0; j<3; j++)
+			{
+				if ( lt & (1<<j) ) imin[j] = i;
+				if ( gt & (1<<j) ) imax[j] = i;
+			}
+		}
+	}
+	#undef HULL_LOADXYZ
+	float fmin[4],fmax[4];
+	_mm_storeu_ps(fmin,mn);
+	_mm_storeu_ps(fmax,mx);
+	for (int j=0; j<3; j++)
+	{
+		b.bmin[j] = fmin[j];
+		b.bmax[j] = fmax[j];
+		b.imin[j] = imin[j];
+		b.imax[j] = imax[j];
+	}
+}
+
+#if !HULL_REAL_FLOAT
+// Only for the double build: in the float one two doubles can round to the same float,
+// and the first of them is the extreme a scalar scan of the rounded values would keep.
+static HULL_TARGET("sse2") void boundsdoublesse2(const char *base,unsigned int stride,unsigned int count,HullBounds &b)
+{
+	__m128d mnxy = _mm_set1_pd( FLT_MAX);
+	__m128d mnz  = mnxy;
+	__m128d mxxy = _mm_set1_pd(-FLT_MAX);
+	__m128d mxz  = mxxy;
+	unsigned int imin[3] = { 0, 0, 0 };
+	unsigned int imax[3] = { 0, 0, 0 };
+	const char *q = base;
+	for (unsigned int i=0; i<count; i++, q+=stride)
+	{
+		__m128d xy = _mm_loadu_pd((const double *)q);
+		__m128d z  = _mm_load_sd((const double *)q+2);
+		int lt = _mm_movemask_pd(_mm_cmplt_pd(xy,mnxy)) | (_mm_movemask_pd(_mm_cmplt_sd(z,mnz))&1)<<2;
+		int gt = _mm_movemask_pd(_mm_cmpgt_pd(xy,mxxy)) | (_mm_movemask_pd(_mm_cmpgt_sd(z,mxz))&1)<<2;
+		if ( lt | gt )
+		{
+			mnxy = _mm_min_pd(mnxy,xy);
+			mxxy = _mm_max_pd(mxxy,xy);
+			mnz  = _mm_min_sd(mnz,z);
+			mxz  = _mm_max_sd(mxz,z);
+			for (int j=0; j<3; j++)
+			{
+				if ( lt & (1<<j) ) imin[j] = i;
+				if ( gt & (1<<j) ) imax[j] = i;
+			}
+		}
+	}
+	double dmin[3],dmax[3];
+	_mm_storeu_pd(dmin,mnxy);
+	_mm_storeu_pd(dmax,mxxy);
+	_mm_store_sd(dmin+2,mnz);
+	_mm_store_sd(dmax+2,mxz);
+	for (int j=0; j<3; j++)
+	{
+		b.bmin[j] = dmin[j];
+		b.bmax[j] = dmax[j];
+		b.imin[j] = imin[j];
+		b.imax[j] = imax[j];
+	}
+}
+#endif
+
+#endif // HULL_SIMD_X86
+
+static BoundsKernel selectboundskernel(bool isfloat)
+{
+#if HULL_SIMD_X86
+	unsigned int r1[4];
+	hullcpuid(1,0,r1);
+	if ( r1[3]&(1<<26) )
+	{
+		if ( isfloat ) return boundsfloatsse2;
+#if !HULL_REAL_FLOAT
+		return boundsdoublesse2;
+#endif
+	}
+#else
+	(void)isfloat;
+#endif
+	return NULL;
+}
+
+static BoundsKernel boundskernel(bool isfloat)
+{
+	static const BoundsKernel floatkernel  = selectboundskernel(true);
+	static const BoundsKernel doublekernel = selectboundskernel(false);
+	return isfloat ? floatkernel : doublekernel;
+}
+
+class HullVertexReader
+{
+public:
+	HullVertexReader(const HullDesc &desc)
+	{
+		mFloat = (desc.mVertexFormat == QV_FLOAT);
+		unsigned int size = mFloat ? sizeof(float) : sizeof(double);
+		if ( desc.mComponents[0] )
+		{
+			for (int j=0; j<3; j++) mBase[j] = (const char *) desc.mComponents[j];
+			mStride = desc.mComponentStride ? desc.mComponentStride : size;
+		}
+		else
+		{
+			const char *v = (const char *) desc.mVertices;
+			for (int j=0; j<3; j++) mBase[j] = v+j*size;
+			mStride = desc.mVertexStride ? desc.mVertexStride : size*3;
+		}
+	}
+
+	void Get(unsigned int i,Real *p) const
+	{
+		size_t offset = (size_t) i*mStride;
+		if ( mFloat )
+		{
+			p[0] = *(const float *)(mBase[0]+offset);
+			p[1] = *(const float *)(mBase[1]+offset);
+			p[2] = *(const float *)(mBase[2]+offset);
+		}
+		else
+		{
+			p[0] = *(const double *)(mBase[0]+offset);
+			p[1] = *(const double *)(mBase[1]+offset);
+			p[2] = *(const double *)(mBase[2]+offset);
+		}
+	}
+
+	// The box of the first count points.  x, y and z side by side, which is
+	// every layout but separate component arrays, goes through the SIMD sweep.
+	void Bounds(unsigned int count,HullBounds &b) const
+	{
+		size_t size = mFloat ? sizeof(float) : sizeof(double);
+		BoundsKernel kernel = boundskernel(mFloat);
+		if ( kernel && mBase[1] == mBase[0]+size && mBase[2] == mBase[0]+2*size )
+		{
+			kernel(mBase[0],mStride,count,b);
+			return;
+		}
+		for (int j=0; j<3; j++)
+		{
+			b.bmin[j] =  FLT_MAX;
+			b.bmax[j] = -FLT_MAX;
+			b.imin[j] = b.imax[j] = 0;
+		}
+		for (unsigned int i=0; i<count; i++)
+		{
+			Real p[3];
+			Get(i,p);
+			for (int j=0; j<3; j++)
+			{
+				if ( p[j] < b.bmin[j] ) { b.bmin[j] = p[j]; b.imin[j] = i; }
+				if ( p[j] > b.bmax[j] ) { b.bmax[j] = p[j]; b.imax[j] = i; }
+			}
+		}
+	}
+
+	const char   *mBase[3];
+	unsigned int  mStride;
+	bool          mFloat;
+};
+
+// Spreads the low 10 bits of x out to every third bit.
+static unsigned int mortonspread(unsigned int x)
+{
+	x &= 0x3FF;
+	x = (x | (x<<16)) & 0x030000FF;
+	x = (x | (x<<8))  & 0x0300F00F;
+	x = (x | (x<<4))  & 0x030C30C3;
+	x = (x | (x<<2))  & 0x09249249;
+	return x;
+}
+
+// QF_SPATIAL_ORDER.  Maya and OBJ vertex order is often scattered all over the model, so
+// every sweep of the hull over the points (maxdir, above, the conflict lists) jumps about
+// memory.  Sorting them along a Morton curve on a 1024^3 grid of their box keeps
+// neighbours close together; sources moves with them, so the results still name input
+// points.  The sort is three stable 10 bit radix passes, points sharing a cell keep
+// their order, and the points are then moved into place one cycle of the order at a time
+// rather than through a copy of the cloud.  The build breaks ties by point order, so
+// where several points would do (coplanar faces, flat input) the hull may pick others.
+static void SpatialOrder(HullScratch &scratch,Real *vsource,unsigned int vcount,const Real *bmin,const Real *bmax)
+{
+	if ( vcount < 2 ) return;
+
+	Array<unsigned int> &m = scratch.morton;
+	m.Resize(vcount*4);
+	unsigned int *key    = &m[0];
+	unsigned int *key2   = &m[vcount];
+	unsigned int *order  = &m[vcount*2];
+	unsigned int *order2 = &m[vcount*3];
+
+	Real grid[3];
+	for (int j=0; j<3; j++)
+	{
+		Real e = bmax[j]-bmin[j];
+		grid[j] = (e > 0) ? 1023/e : 0;
+	}
+
+	for (unsigned int i=0; i<vcount; i++)
+	{
+		const Real *v = &vsource[i*3];
+		unsigned int x = (unsigned int) ((v[0]-bmin[0])*grid[0]);
+		unsigned int y = (unsigned int) ((v[1]-bmin[1])*grid[1]);
+		unsigned int z = (unsigned int) ((v[2]-bmin[2])*grid[2]);
+		key[i]   = mortonspread(x) | mortonspread(y)<<1 | mortonspread(z)<<2;
+		order[i] = i;
+	}
+
+	for (int shift=0; shift<30; shift+=10)
+	{
+		unsigned int start[1025];
+		memset(start,0,sizeof(start));
+		for (unsigned int i=0; i<vcount; i++) start[((key[i]>>shift)&1023)+1]++;
+		for (int b=0; b<1024; b++) start[b+1] += start[b];
+		for (unsigned int i=0; i<vcount; i++)
+		{
+			unsigned int d = start[(key[i]>>shift)&1023]++;
+			key2[d]   = key[i];
+			order2[d] = order[i];
+		}
+		unsigned int *t;
+		t = key;   key   = key2;   key2   = t;
+		t = order; order = order2; order2 = t;
+	}
+
+	// point i takes the one at order[i], each cycle marked done as it is walked
+	unsigned int *sources = scratch.sources.element;
+	for (unsigned int i=0; i<vcount; i++)
+	{
+		if ( order[i] == i ) continue;
+		Real x = vsource[i*3+0];
+		Real y = vsource[i*3+1];
+		Real z = vsource[i*3+2];
+		unsigned int s = sources[i];
+		unsigned int j = i;
+		for (;;)
+		{
+			unsigned int k = order[j];
+			order[j] = j;
+			if ( k == i ) break;
+			vsource[j*3+0] = vsource[k*3+0];
+			vsource[j*3+1] = vsource[k*3+1];
+			vsource[j*3+2] = vsource[k*3+2];
+			sources[j] = sources[k];
+			j = k;
+		}
+		vsource[j*3+0] = x;
+		vsource[j*3+1] = y;
+		vsource[j*3+2] = z;
+		sources[j] = s;
+	}
+}
+
+// QF_CORESET: the points a hull no further than error from the input's can be built
+// from, found in one pass over the raw input.  Seen along the longest axis of the box,
+// the input is cut into square columns error/sqrt(2) wide and each column keeps its
+// lowest and highest point.  Every other point of a column lies between those two in
+// height and within the column across, so it is no further than the column's diagonal,
+// error, from the segment joining them.  The extremes of the box are kept too, so that
+// cleanup normalizes the same box.  Leaves the input indices of the points kept in
+// ascending order in scratch.coreset and returns how many there are, or 0 when there
+// would be so many columns that the whole input is as quick to hull.
+static unsigned int Coreset(const HullDesc &desc,const HullBounds &bounds,Real error,HullScratch &scratch)
+{
+	unsigned int vcount = desc.mVcount;
+	const Real *bmin = bounds.bmin;
+	const Real *bmax = bounds.bmax;
+	int l = 0;
+	for (int j=1; j<3; j++)
+	{
+		if ( bmax[j]-bmin[j] > bmax[l]-bmin[l] ) l = j;
+	}
+	int a = (l+1)%3;
+	int b = (l+2)%3;
+
+	Real width = error*0.70710678f; // error/sqrt(2)
+	if ( !(width > 0) ) return 0;
+	double na = floor((bmax[a]-bmin[a])/width)+1;
+	double nb = floor((bmax[b]-bmin[b])/width)+1;
+	if ( na*nb*4 > (double)vcount ) return 0; // fewer than four points a column
+	unsigned int ca = (unsigned int) na;
+	unsigned int cb = (unsigned int) nb;
+	Real recip = 1/width;
+
+	// per column the lowest and the highest point so far, and their heights
+	Array<int>  &column = scratch.column;
+	Array<Real> &height = scratch.height;
+	column.Resize(ca*cb*2);
+	height.Resize(ca*cb*2);
+	memset(column.element,0xFF,sizeof(int)*ca*cb*2); // all -1
+
+	HullVertexReader src(desc);
+	for (unsigned int i=0; i<vcount; i++)
+	{
+		Real p[3];
+		src.Get(i,p);
+		unsigned int u = Min((unsigned int) ((p[a]-bmin[a])*recip),ca-1);
+		unsigned int v = Min((unsigned int) ((p[b]-bmin[b])*recip),cb-1);
+		unsigned int c = (u*cb+v)*2;
+		Real h = p[l];
+		if ( column[c] < 0 )
+		{
+			column[c] = column[c+1] = (int) i;
+			height[c] = height[c+1] = h;
+		}
+		else if ( h < height[c] )
+		{
+			column[c] = (int) i;
+			height[c] = h;
+		}
+		else if ( h > height[c+1] )
+		{
+			column[c+1] = (int) i;
+			height[c+1] = h;
+		}
+	}
+
+	HullBits &kept = scratch.corekept;
+	kept.Clear();
+	kept.Resize(vcount);
+	for (unsigned int c=0; c<ca*cb*2; c++)
+	{
+		if ( column[c] >= 0 ) kept.Set(column[c]);
+	}
+	for (int j=0; j<3; j++)
+	{
+		kept.Set(bounds.imin[j]);
+		kept.Set(bounds.imax[j]);
+	}
+
+	Array<unsigned int> &coreset = scratch.coreset;
+	coreset.count = 0;
+	for (int w=0; w<kept.bits.count; w++)
+	{
+		unsigned int bits = kept.bits[w];
+		for (int k=0; bits; k++, bits>>=1)
+		{
+			if ( bits&1 ) coreset.Add(w*32+k);
+		}
+	}
+	return coreset.count;
+}
+
+// QF_SMALL_INPUT: a hull of a few dozen points is over before the general build has
+// set up its triangle pool and heap, so batches of tiny hulls go through a second
+// engine instead.  It keeps the whole hull in fixed arrays on the stack, finds the
+// point furthest above a face with a SIMD kernel over all the points at once, and
+// looks for the next face to extrude with a plain scan.  It works from the same
+// cleaned up points with the same epsilons as calchullgen, and hands back false for
+// anything it cannot take (a flat or needle like cloud, say) so the general build
+// can go on from there.  Where points tie or lie within epsilon of a face it may keep
+// other ones than calchullgen would, otherwise the hull is the same.
+
+#define SMALLHULL_MAX   64                 // most points the small engine takes, a multiple of 8
+#define SMALLHULL_FACES (SMALLHULL_MAX*2)  // a hull of n points has at most 2n-4 triangles
+
+typedef int (*PlaneDistKernel)(const Real *x,const Real *y,const Real *z,const Real *bias,int count,const real3 &o,const real3 &n,Real *d,Real &dm);
+
+// The first i with the largest d[i] = dot(n,p[i]-o)+bias[i], and that dm, for points kept
+// one array per axis and count a multiple of 8.  A bias of 0 leaves a distance as it is,
+// -FLT_MAX buries it.  The vector kernels write every d[i] and find the largest of them
+// before looking for it, so there is no branch per point to mispredict.
+static HULL_NOCONTRACT int planedistscalar(const Real *x,const Real *y,const Real *z,const Real *bias,int count,const real3 &o,const real3 &n,Real *d,Real &dm)
+{
+	HULL_PRECISE_BLOCK
+	int m = 0;
+	dm = -FLT_MAX;
+	for(int i=0;i<count;i++)
+	{
+		d[i] = (((x[i]-o.x)*n.x + (y[i]-o.y)*n.y) + (z[i]-o.z)*n.z) + bias[i];
+		if(d[i]>dm)
+		{
+			m  = i;
+			dm = d[i];
+		}
+	}
+	return m;
+}
+
+// The first lane set in a non zero movemask.
+static int firstlane(int mask)
+{
+	int k = 0;
+	while(!(mask&(1<<k))) k++;
+	return k;
+}
+
+#if HULL_SIMD_X86
+#if HULL_REAL_FLOAT
+
+static HULL_TARGET("sse2") HULL_NOCONTRACT int planedistsse2(const float *x,const float *y,const float *z,const float *bias,int count,const real3 &o,const real3 &n,float *d,float &dm)
+{
+	HULL_PRECISE_BLOCK
+	const __m128 ox = _mm_set1_ps(o.x), oy = _mm_set1_ps(o.y), oz = _mm_set1_ps(o.z);
+	const __m128 nx = _mm_set1_ps(n.x), ny = _mm_set1_ps(n.y), nz = _mm_set1_ps(n.z);
+	__m128 best = _mm_set1_ps(-FLT_MAX);
+	for(int i=0;i<count;i+=4)
+	{
+		__m128 dx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(x+i),ox),nx);
+		__m128 dy = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(y+i),oy),ny);
+		__m128 dz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(z+i),oz),nz);
+		__m128 di = _mm_add_ps(_mm_add_ps(_mm_add_ps(dx,dy),dz),_mm_loadu_ps(bias+i));
+		_mm_storeu_ps(d+i,di);
+		best = _mm_max_ps(best,di);
+	}
+	float m[4];
+	_mm_storeu_ps(m,best);
+	dm = Max(Max(m[0],m[1]),Max(m[2],m[3]));
+	const __m128 top = _mm_set1_ps(dm);
+	int i=0,mask;
+	while(!(mask=_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(d+i),top))) && i+4<count) i+=4;
+	return mask ? i+firstlane(mask) : 0; // no lane when it is NaN
+}
+
+static HULL_TARGET("avx2") HULL_NOCONTRACT int planedistavx2(const float *x,const float *y,const float *z,const float *bias,int count,const real3 &o,const real3 &n,float *d,float &dm)
+{
+	HULL_PRECISE_BLOCK
+	const __m256 ox = _mm256_set1_ps(o.x), oy = _mm256_set1_ps(o.y), oz = _mm256_set1_ps(o.z);
+	const __m256 nx = _mm256_set1_ps(n.x), ny = _mm256_set1_ps(n.y), nz = _mm256_set1_ps(n.z);
+	__m256 best = _mm256_set1_ps(-FLT_MAX);
+	for(int i=0;i<count;i+=8)
+	{
+		__m256 dx = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x+i),ox),nx);
+		__m256 dy = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(y+i),oy),ny);
+		__m256 dz = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(z+i),oz),nz);
+		__m256 di = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(dx,dy),dz),_mm256_loadu_ps(bias+i));
+		_mm256_storeu_ps(d+i,di);
+		best = _mm256_max_ps(best,di);
+	}
+	float m[8];
+	_mm256_storeu_ps(m,best);
+	dm = Max(Max(Max(m[0],m[1]),Max(m[2],m[3])),Max(Max(m[4],m[5]),Max(m[6],m[7])));
+	const __m256 top = _mm256_set1_ps(dm);
+	int i=0,mask;
+	while(!(mask=_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(d+i),top,_CMP_EQ_OQ))) && i+8<count) i+=8;
+	return mask ? i+firstlane(mask) : 0; // no lane when it is NaN
+}
+
+#else
+
+static HULL_TARGET("sse2") HULL_NOCONTRACT int planedistsse2(const double *x,const double *y,const double *z,const double *bias,int count,const real3 &o,const real3 &n,double *d,double &dm)
+{
+	HULL_PRECISE_BLOCK
+	const __m128d ox = _mm_set1_pd(o.x), oy = _mm_set1_pd(o.y), oz = _mm_set1_pd(o.z);
+	const __m128d nx = _mm_set1_pd(n.x), ny = _mm_set1_pd(n.y), nz = _mm_set1_pd(n.z);
+	__m128d best = _mm_set1_pd(-FLT_MAX);
+	for(int i=0;i<count;i+=2)
+	{
+		__m128d dx = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(x+i),ox),nx);
+		__m128d dy = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(y+i),oy),ny);
+		__m128d dz = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(z+i),oz),nz);
+		__m128d di = _mm_add_pd(_mm_add_pd(_mm_add_pd(dx,dy),dz),_mm_loadu_pd(bias+i));
+		_mm_storeu_pd(d+i,di);
+		best = _mm_max_pd(best,di);
+	}
+	double m[2];
+	_mm_storeu_pd(m,best);
+	dm = Max(m[0],m[1]);
+	const __m128d top = _mm_set1_pd(dm);
+	int i=0,mask;
+	while(!(mask=_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(d+i),top))) && i+2<count) i+=2;
+	return mask ? i+firstlane(mask) : 0; // no lane when it is NaN
+}
+
+static HULL_TARGET("avx2") HULL_NOCONTRACT int planedistavx2(const double *x,const double *y,const double *z,const double *bias,int count,const real3 &o,const real3 &n,double *d,double &dm)
+{
+	HULL_PRECISE_BLOCK
+	const __m256d ox = _mm256_set1_pd(o.x), oy = _mm256_set1_pd(o.y), oz = _mm256_set1_pd(o.z);
+	const __m256d nx = _mm256_set1_pd(n.x), ny = _mm256_set1_pd(n.y), nz = _mm256_set1_pd(n.z);
+	__m256d best = _mm256_set1_pd(-FLT_MAX);
+	for(int i=0;i<count;i+=4)
+	{
+		__m256d dx = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(x+i),ox),nx);
+		__m256d dy = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(y+i),oy),ny);
+		__m256d dz = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(z+i),oz),nz);
+		__m256d di = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(dx,dy),dz),_mm256_loadu_pd(bias+i));
+		_mm256_storeu_pd(d+i,di);
+		best = _mm256_max_pd(best,di);
+	}
+	double m[4];
+	_mm256_storeu_pd(m,best);
+	dm = Max(Max(m[0],m[1]),Max(m[2],m[3]));
+	const __m256d top = _mm256_set1_pd(dm);
+	int i=0,mask;
+	while(!(mask=_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(d+i),top,_CMP_EQ_OQ))) && i+4<count) i+=4;
+	return mask ? i+firstlane(mask) : 0; // no lane when it is NaN
+}
+
+#endif // HULL_REAL_FLOAT
+#endif // HULL_SIMD_X86
+
+static PlaneDistKernel selectplanedistkernel(void)
+{
+#if HULL_SIMD_X86
+	unsigned int r0[4],r1[4],r7[4]={0,0,0,0};
+	hullcpuid(0,0,r0);
+	hullcpuid(1,0,r1);
+	if(r0[0]>=7) hullcpuid(7,0,r7);
+	bool sse2    = (r1[3]&(1<<26))!=0;
+	bool osxsave = (r1[2]&(1<<27))!=0;
+	bool avx     = (r1[2]&(1<<28))!=0;
+	unsigned long long xcr0 = osxsave ? hullxgetbv() : 0;
+	bool ymm = (xcr0&0x06)==0x06;   // OS saves xmm/ymm state
+	if(avx && ymm && (r7[1]&(1<<5))) return planedistavx2;
+	if(sse2) return planedistsse2;
+#endif
+	return planedistscalar;
+}
+
+static PlaneDistKernel planedistkernel(void)
+{
+	static const PlaneDistKernel kernel = selectplanedistkernel();
+	return kernel;
+}
+
+// CreateConvexHulls with QF_SMALL_INPUT hulls several small sets side by side, one per
+// SIMD lane (SmallLanes).  Their points are interleaved, point i of lane k at
+// i*SMALLHULL_LANES+k, so one pass over the points measures a face of every set.
+#if HULL_REAL_FLOAT
+#define SMALLHULL_LANES 8
+#else
+#define SMALLHULL_LANES 4
+#endif
+
+// A face of each lane's set, and the first point furthest above it once measured.
+class LaneQuery
+{
+public:
+	Real ox[SMALLHULL_LANES];   // a vertex of the face
+	Real oy[SMALLHULL_LANES];
+	Real oz[SMALLHULL_LANES];
+	Real nx[SMALLHULL_LANES];   // its normal, 0 for a lane with nothing to ask
+	Real ny[SMALLHULL_LANES];
+	Real nz[SMALLHULL_LANES];
+	int  m[SMALLHULL_LANES];    // the first i with the largest dot(n,p[i]-o)+bias[i]
+	Real dm[SMALLHULL_LANES];   // ... and that value
+};
+
+typedef void (*LaneDistKernel)(const Real *x,const Real *y,const Real *z,const Real *bias,int count,LaneQuery &q);
+
+// The same sums in the same order as planedistscalar, so each lane gets the answer its
+// set would get from planedistkernel on its own.
+static HULL_NOCONTRACT void lanedistscalar(const Real *x,const Real *y,const Real *z,const Real *bias,int count,LaneQuery &q)
+{
+	HULL_PRECISE_BLOCK
+	for(int k=0;k<SMALLHULL_LANES;k++)
+	{
+		int  m  = 0;
+		Real dm = -FLT_MAX;
+		for(int i=0;i<count;i++)
+		{
+			int  j = i*SMALLHULL_LANES+k;
+			Real d = (((x[j]-q.ox[k])*q.nx[k] + (y[j]-q.oy[k])*q.ny[k]) + (z[j]-q.oz[k])*q.nz[k]) + bias[j];
+			if(d>dm)
+			{
+				m  = i;
+				dm = d;
+			}
+		}
+		q.m[k]  = m;
+		q.dm[k] = dm;
+	}
+}
+
+#if HULL_SIMD_X86
+#if HULL_REAL_FLOAT
+
+static HULL_TARGET("sse2") HULL_NOCONTRACT void lanedistsse2(const float *x,const float *y,const float *z,const float *bias,int count,LaneQuery &q)
+{
+	HULL_PRECISE_BLOCK
+	for(int h=0;h<SMALLHULL_LANES;h+=4)
+	{
+		const __m128 ox = _mm_loadu_ps(q.ox+h), oy = _mm_loadu_ps(q.oy+h), oz = _mm_loadu_ps(q.oz+h);
+		const __m128 nx = _mm_loadu_ps(q.nx+h), ny = _mm_loadu_ps(q.ny+h), nz = _mm_loadu_ps(q.nz+h);
+		__m128 best = _mm_set1_ps(-FLT_MAX);
+		__m128 at   = _mm_setzero_ps();
+		for(int i=0;i<count;i++)
+		{
+			int j = i*SMALLHULL_LANES+h;
+			__m128 dx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(x+j),ox),nx);
+			__m128 dy = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(y+j),oy),ny);
+			__m128 dz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(z+j),oz),nz);
+			__m128 di = _mm_add_ps(_mm_add_ps(_mm_add_ps(dx,dy),dz),_mm_loadu_ps(bias+j));
+			__m128 gt = _mm_cmpgt_ps(di,best);
+			best = _mm_or_ps(_mm_and_ps(gt,di),_mm_andnot_ps(gt,best));
+			at   = _mm_or_ps(_mm_and_ps(gt,_mm_set1_ps((float)i)),_mm_andnot_ps(gt,at));
+		}
+		float m[4];
+		_mm_storeu_ps(m,at);
+		_mm_storeu_ps(q.dm+h,best);
+		for(int k=0;k<4;k++) q.m[h+k] = (int) m[k];
+	}
+}
+
+static HULL_TARGET("avx2") HULL_NOCONTRACT void lanedistavx2(const float *x,const float *y,const float *z,const float *bias,int count,LaneQuery &q)
+{
+	HULL_PRECISE_BLOCK
+	const __m256 ox = _mm256_loadu_ps(q.ox), oy = _mm256_loadu_ps(q.oy), oz = _mm256_loadu_ps(q.oz);
+	const __m256 nx = _mm256_loadu_ps(q.nx), ny = _mm256_loadu_ps(q.ny), nz = _mm256_loadu_ps(q.nz);
+	__m256 best = _mm256_set1_ps(-FLT_MAX);
+	__m256 at   = _mm256_setzero_ps();
+	for(int i=0;i<count;i++)
+	{
+		int j = i*SMALLHULL_LANES;
+		__m256 dx = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x+j),ox),nx);
+		__m256 dy = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(y+j),oy),ny);
+		__m256 dz = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(z+j),oz),nz);
+		__m256 di = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(dx,dy),dz),_mm256_loadu_ps(bias+j));
+		__m256 gt = _mm256_cmp_ps(di,best,_CMP_GT_OQ);
+		best = _mm256_blendv_ps(best,di,gt);
+		at   = _mm256_blendv_ps(at,_mm256_set1_ps((float)i),gt);
+	}
+	float m[8];
+	_mm256_storeu_ps(m,at);
+	_mm256_storeu_ps(q.dm,best);
+	for(int k=0;k<8;k++) q.m[k] = (int) m[k];
+}
+
+#else
+
+static HULL_TARGET("sse2") HULL_NOCONTRACT void lanedistsse2(const double *x,const double *y,const double *z,const double *bias,int count,LaneQuery &q)
+{
+	HULL_PRECISE_BLOCK
+	for(int h=0;h<SMALLHULL_LANES;h+=2)
+	{
+		const __m128d ox = _mm_loadu_pd(q.ox+h), oy = _mm_loadu_pd(q.oy+h), oz = _mm_loadu_pd(q.oz+h);
+		const __m128d nx = _mm_loadu_pd(q.nx+h), ny = _mm_loadu_pd(q.ny+h), nz = _mm_loadu_pd(q.nz+h);
+		__m128d best = _mm_set1_pd(-FLT_MAX);
+		__m128d at   = _mm_setzero_pd();
+		for(int i=0;i<count;i++)
+		{
+			int j = i*SMALLHULL_LANES+h;
+			__m128d dx = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(x+j),ox),nx);
+			__m128d dy = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(y+j),oy),ny);
+			__m128d dz = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(z+j),oz),nz);
+			__m128d di = _mm_add_pd(_mm_add_pd(_mm_add_pd(dx,dy),dz),_mm_loadu_pd(bias+j));
+			__m128d gt = _mm_cmpgt_pd(di,best);
+			best = _mm_or_pd(_mm_and_pd(gt,di),_mm_andnot_pd(gt,best));
+			at   = _mm_or_pd(_mm_and_pd(gt,_mm_set1_pd((double)i)),_mm_andnot_pd(gt,at));
+		}
+		double m[2];
+		_mm_storeu_pd(m,at);
+		_mm_storeu_pd(q.dm+h,best);
+		for(int k=0;k<2;k++) q.m[h+k] = (int) m[k];
+	}
+}
+
+static HULL_TARGET("avx2") HULL_NOCONTRACT void lanedistavx2(const double *x,const double *y,const double *z,const double *bias,int count,LaneQuery &q)
+{
+	HULL_PRECISE_BLOCK
+	const __m256d ox = _mm256_loadu_pd(q.ox), oy = _mm256_loadu_pd(q.oy), oz = _mm256_loadu_pd(q.oz);
+	const __m256d nx = _mm256_loadu_pd(q.nx), ny = _mm256_loadu_pd(q.ny), nz = _mm256_loadu_pd(q.nz);
+	__m256d best = _mm256_set1_pd(-FLT_MAX);
+	__m256d at   = _mm256_setzero_pd();
+	for(int i=0;i<count;i++)
+	{
+		int j = i*SMALLHULL_LANES;
+		__m256d dx = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(x+j),ox),nx);
+		__m256d dy = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(y+j),oy),ny);
+		__m256d dz = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(z+j),oz),nz);
+		__m256d di = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(dx,dy),dz),_mm256_loadu_pd(bias+j));
+		__m256d gt = _mm256_cmp_pd(di,best,_CMP_GT_OQ);
+		best = _mm256_blendv_pd(best,di,gt);
+		at   = _mm256_blendv_pd(at,_mm256_set1_pd((double)i),gt);
+	}
+	double m[4];
+	_mm256_storeu_pd(m,at);
+	_mm256_storeu_pd(q.dm,best);
+	for(int k=0;k<4;k++) q.m[k] = (int) m[k];
+}
+
+#endif // HULL_REAL_FLOAT
+#endif // HULL_SIMD_X86
+
+static LaneDistKernel selectlanedistkernel(void)
+{
+#if HULL_SIMD_X86
+	unsigned int r0[4],r1[4],r7[4]={0,0,0,0};
+	hullcpuid(0,0,r0);
+	hullcpuid(1,0,r1);
+	if(r0[0]>=7) hullcpuid(7,0,r7);
+	bool sse2    = (r1[3]&(1<<26))!=0;
+	bool osxsave = (r1[2]&(1<<27))!=0;
+	bool avx     = (r1[2]&(1<<28))!=0;
+	unsigned long long xcr0 = osxsave ? hullxgetbv() : 0;
+	bool ymm = (xcr0&0x06)==0x06;   // OS saves xmm/ymm state
+	if(avx && ymm && (r7[1]&(1<<5))) return lanedistavx2;
+	if(sse2) return lanedistsse2;
+#endif
+	return lanedistscalar;
+}
+
+static LaneDistKernel lanedistkernel(void)
+{
+	static const LaneDistKernel kernel = selectlanedistkernel();
+	return kernel;
+}
+
+// The whole state of a small hull.  Face f has vertices face[f][0..2], counterclockwise
+// seen from outside, and nb[f][j] is the face on the other side of its edge from
+// vertex j to vertex j+1.
+class SmallHull
+{
+public:
+	Real         x[SMALLHULL_MAX];              // the points, one array per axis and padded
+	Real         y[SMALLHULL_MAX];              // with zeros to a multiple of 8
+	Real         z[SMALLHULL_MAX];
+	Real         bias[SMALLHULL_MAX];           // -FLT_MAX for hull vertices and padding, 0 for the rest
+	Real         dist[SMALLHULL_MAX];           // how far each is above the face being looked at
+	int          startedge[SMALLHULL_MAX];      // the horizon edge starting at each point, -1 for none
+	int          endedge[SMALLHULL_MAX];        // ... and ending at it
+	int          face[SMALLHULL_FACES][3];
+	int          nb[SMALLHULL_FACES][3];
+	real3        normal[SMALLHULL_FACES];
+	Real         rise[SMALLHULL_FACES];         // how far the point furthest above each face is above it
+	int          vmax[SMALLHULL_FACES];         // ... and which point that is, -1 when none is left
+	int          visit[SMALLHULL_FACES];        // the point each face was last tested against
+	char         state[SMALLHULL_FACES];        // 0 free, 1 on the hull, 2 seen by the point being added
+	int          freeface[SMALLHULL_FACES];     // the slots given back
+	int          freecount;
+	int          facecount;                     // slots handed out so far
+	int          visible[SMALLHULL_FACES];      // the faces the point being added sees
+	int          horizon[SMALLHULL_FACES][3];   // ... the edges around them, from, to and the face outside
+	int          newface[SMALLHULL_FACES];      // ... and the face made from each edge
+	int          newcount;                      // the faces made by the last step, still to be measured
+	unsigned int indices[SMALLHULL_FACES*3];    // the finished triangles
+	int          count;                         // how many points there are
+	int          hullverts;                     // ... and how many of them are on the hull
+	Real         epsilon;
+	real3        center;                        // a point inside the hull
+};
+
+// Takes a slot for the face a,b,c, or -1 if there are none left.
+static int smallface(SmallHull &sh,const real3 *verts,int a,int b,int c)
+{
+	int f;
+	if ( sh.freecount ) f = sh.freeface[--sh.freecount];
+	else if ( sh.facecount < SMALLHULL_FACES ) f = sh.facecount++;
+	else return -1;
+	sh.face[f][0] = a;
+	sh.face[f][1] = b;
+	sh.face[f][2] = c;
+	sh.normal[f]  = TriNormal(verts[a],verts[b],verts[c]);
+	sh.visit[f]   = -1;
+	sh.state[f]   = 1;
+	sh.vmax[f]    = -1;
+	sh.rise[f]    = 0;
+	return f;
+}
+
+// Finds the point not yet on the hull that is furthest above face f, the first of them on ties.
+static void smallfurthest(SmallHull &sh,const real3 *verts,int f,PlaneDistKernel kernel)
+{
+	Real dm;
+	int  m    = kernel(sh.x,sh.y,sh.z,sh.bias,(sh.count+7)&~7,verts[sh.face[f][0]],sh.normal[f],sh.dist,dm);
+	bool none = (sh.bias[m] != 0);
+	sh.vmax[f] = none ? -1 : m;
+	sh.rise[f] = none ? 0 : dm;
+}
+
+// Whether the small engine takes vcount cleaned up points built as desc asks.  The
+// general build handles everything that changes how the hull is grown.
+static bool smallaccepts(const HullDesc &desc,unsigned int vcount)
+{
+	if ( vcount < 4 || vcount > SMALLHULL_MAX ) return false;
+	if ( desc.HasHullFlag(QF_SKIN_WIDTH) || desc.HasHullFlag(QF_EXACT_PREDICATES) ) return false;
+	if ( (desc.mHintIndices && desc.mHintCount) || desc.mTolerance > 0 || desc.mRelativeTolerance > 0 ) return false;
+	return true;
+}
+
+// Sets sh up with the count points in verts and the simplex of them, whose four faces are
+// left in newface to be measured.  Returns false for a flat or needle like cloud.
+static bool smallstart(SmallHull &sh,const real3 *verts,int count,const Real *bmin,const Real *bmax)
+{
+	for (int i=0; i<((count+7)&~7); i++)
+	{
+		bool in = (i < count);
+		sh.x[i]    = in ? verts[i].x : 0;
+		sh.y[i]    = in ? verts[i].y : 0;
+		sh.z[i]    = in ? verts[i].z : 0;
+		sh.bias[i] = in ? 0 : -FLT_MAX;
+		sh.startedge[i] = -1;
+		sh.endedge[i]   = -1;
+	}
+	sh.freecount = 0;
+	sh.facecount = 0;
+	sh.count     = count;
+
+	real3 extent(bmax[0]-bmin[0],bmax[1]-bmin[1],bmax[2]-bmin[2]);
+	Real epsilon = magnitude(extent) * 0.001f;
+	sh.epsilon   = epsilon;
+
+	// the simplex: the ends of the widest axis, the point furthest from the line through
+	// them and the point furthest from the plane through all three
+	int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+	int a = 0, b = 0;
+	for (int i=1; i<count; i++)
+	{
+		if ( verts[i][axis] < verts[a][axis] ) a = i;
+		if ( verts[i][axis] > verts[b][axis] ) b = i;
+	}
+	if ( a == b ) return false;
+	real3 ab = verts[b]-verts[a];
+	int  c    = -1;
+	Real best = sqr(epsilon)*dot(ab,ab);
+	for (int i=0; i<count; i++)
+	{
+		real3 cp = cross(verts[i]-verts[a],ab);
+		Real  m  = dot(cp,cp);
+		if ( m > best )
+		{
+			c    = i;
+			best = m;
+		}
+	}
+	if ( c < 0 ) return false;
+	real3 pn = normalize(cross(ab,verts[c]-verts[a]));
+	int d = -1;
+	best = epsilon;
+	for (int i=0; i<count; i++)
+	{
+		Real h = fabs(dot(pn,verts[i]-verts[a]));
+		if ( h > best )
+		{
+			d    = i;
+			best = h;
+		}
+	}
+	if ( d < 0 ) return false;
+
+	int s[4] = { a, b, c, d };
+	for (int k=0; k<4; k++)
+	{
+		// the face opposite s[k], turned so that s[k] is below it
+		int p = s[(k+1)&3], q = s[(k+2)&3], r = s[(k+3)&3];
+		if ( dot(cross(verts[q]-verts[p],verts[r]-verts[q]),verts[s[k]]-verts[p]) > 0 ) Swap(q,r);
+		sh.newface[k] = smallface(sh,verts,p,q,r);
+		sh.bias[s[k]] = -FLT_MAX;
+	}
+	sh.newcount  = 4;
+	sh.hullverts = 4;
+	for (int f=0; f<4; f++)
+	{
+		for (int j=0; j<3; j++)
+		{
+			int from = sh.face[f][j], to = sh.face[f][(j+1)%3];
+			for (int g=0; g<4; g++)
+			{
+				for (int i=0; i<3; i++)
+				{
+					if ( sh.face[g][i] == to && sh.face[g][(i+1)%3] == from ) sh.nb[f][j] = g;
+				}
+			}
+		}
+	}
+	sh.center = (verts[a]+verts[b]+verts[c]+verts[d]) / 4.0f;  // a valid interior point
+	return true;
+}
+
+// The face whose furthest point is highest above it, or -1 once no point is more than
+// epsilon outside the hull.
+static int smallpick(const SmallHull &sh)
+{
+	int te = -1;
+	for (int f=0; f<sh.facecount; f++)
+	{
+		if ( sh.state[f] == 1 && sh.vmax[f] >= 0 && sh.rise[f] > sh.epsilon && (te < 0 || sh.rise[f] > sh.rise[te]) ) te = f;
+	}
+	return te;
+}
+
+// Adds the point furthest above face te to the hull, leaving the faces made for it in
+// newface to be measured.  Returns false when the horizon comes out broken or the face
+// slots run out.
+static bool smalladd(SmallHull &sh,const real3 *verts,int te)
+{
+	Real epsilon = sh.epsilon;
+	int  v       = sh.vmax[te];
+	const real3 &p = verts[v];
+	sh.bias[v] = -FLT_MAX;
+	sh.hullverts++;
+
+	// the faces that can see v form a connected patch around te
+	int nvisible = 0;
+	sh.visit[te] = v;
+	sh.state[te] = 2;
+	sh.visible[nvisible++] = te;
+	for (int k=0; k<nvisible; k++)
+	{
+		for (int j=0; j<3; j++)
+		{
+			int g = sh.nb[sh.visible[k]][j];
+			if ( sh.visit[g] == v ) continue;
+			sh.visit[g] = v;
+			if ( dot(sh.normal[g],p-verts[sh.face[g][0]]) > 0.01f*epsilon )
+			{
+				sh.state[g] = 2;
+				sh.visible[nvisible++] = g;
+			}
+		}
+	}
+
+	// joining v to the horizon around them must not make a flipped or a really skinny
+	// triangle, when it would the face past that edge has to go too
+	int nhorizon;
+	for (;;)
+	{
+		nhorizon = 0;
+		for (int k=0; k<nvisible; k++)
+		{
+			int f = sh.visible[k];
+			for (int j=0; j<3; j++)
+			{
+				int g = sh.nb[f][j];
+				if ( sh.state[g] == 2 ) continue;
+				sh.horizon[nhorizon][0] = sh.face[f][j];
+				sh.horizon[nhorizon][1] = sh.face[f][(j+1)%3];
+				sh.horizon[nhorizon][2] = g;
+				nhorizon++;
+			}
+		}
+		int bad = -1;
+		for (int h=0; h<nhorizon && bad<0; h++)
+		{
+			const real3 &v0 = verts[sh.horizon[h][0]];
+			const real3 &v1 = verts[sh.horizon[h][1]];
+			real3 cp = cross(v1-v0,p-v1);
+			Real  m  = magnitude(cp);
+			if ( m < epsilon*epsilon*0.1f || dot(cp*(1.0f/m),sh.center-v0) > 0.01f*epsilon ) bad = h;
+		}
+		if ( bad < 0 ) break;
+		int g = sh.horizon[bad][2];
+		sh.state[g] = 2;
+		sh.visible[nvisible++] = g;
+	}
+
+	// the horizon has to be one loop through each of its points once
+	bool loop = (nhorizon >= 3);
+	for (int h=0; h<nhorizon && loop; h++)
+	{
+		int from = sh.horizon[h][0], to = sh.horizon[h][1];
+		if ( sh.startedge[from] >= 0 || sh.endedge[to] >= 0 ) loop = false;
+		sh.startedge[from] = h;
+		sh.endedge[to]     = h;
+	}
+	if ( loop )
+	{
+		int h = 0, steps = 0;
+		do
+		{
+			h = sh.startedge[sh.horizon[h][1]];
+			steps++;
+		} while ( h > 0 && steps < nhorizon );
+		loop = (h == 0 && steps == nhorizon);
+	}
+	if ( !loop ) return false;
+
+	for (int k=0; k<nvisible; k++)
+	{
+		sh.state[sh.visible[k]] = 0;
+		sh.freeface[sh.freecount++] = sh.visible[k];
+	}
+	for (int h=0; h<nhorizon; h++)
+	{
+		sh.newface[h] = smallface(sh,verts,sh.horizon[h][0],sh.horizon[h][1],v);
+		if ( sh.newface[h] < 0 ) return false;
+	}
+	for (int h=0; h<nhorizon; h++)
+	{
+		int f = sh.newface[h], from = sh.horizon[h][0], to = sh.horizon[h][1], g = sh.horizon[h][2];
+		sh.nb[f][0] = g;
+		sh.nb[f][1] = sh.newface[sh.startedge[to]];
+		sh.nb[f][2] = sh.newface[sh.endedge[from]];
+		for (int j=0; j<3; j++)
+		{
+			if ( sh.face[g][j] == to && sh.face[g][(j+1)%3] == from ) sh.nb[g][j] = f;
+		}
+	}
+	for (int h=0; h<nhorizon; h++)
+	{
+		sh.startedge[sh.horizon[h][0]] = -1;
+		sh.endedge[sh.horizon[h][1]]   = -1;
+	}
+	sh.newcount = nhorizon;
+	return true;
+}
+
+// Once the new faces are measured: the faces v was the furthest point of and that did
+// not see it were no more than 0.01*epsilon below it, nothing else is further.
+static void smalldone(SmallHull &sh,int v)
+{
+	for (int f=0; f<sh.facecount; f++)
+	{
+		if ( sh.vmax[f] == v ) sh.vmax[f] = -1;
+	}
+}
+
+// Hands the finished hull of the vcount points in vsource on to FinishHull.
+static void smallfinish(HullScratch &scratch,const HullDesc &desc,SmallHull &sh,Real *vsource,const unsigned int *sources,unsigned int vcount,HullResultT<Real> &result)
+{
+	// the rises only know the points that were off the hull when each face was measured,
+	// so the error comes from every point against every face
+	const real3 *verts = (const real3 *) vsource;
+	PlaneDistKernel kernel = planedistkernel();
+	for (int i=0; i<sh.count; i++) sh.bias[i] = 0;
+	unsigned int icount = 0;
+	Real error = 0;
+	for (int f=0; f<sh.facecount; f++)
+	{
+		if ( sh.state[f] != 1 ) continue;
+		for (int j=0; j<3; j++) sh.indices[icount++] = (unsigned int) sh.face[f][j];
+		Real dm;
+		kernel(sh.x,sh.y,sh.z,sh.bias,(sh.count+7)&~7,verts[sh.face[f][0]],sh.normal[f],sh.dist,dm);
+		if ( dm > error ) error = dm;
+	}
+
+	PHullResult hr;
+	hr.mVcount     = vcount;
+	hr.mVertices   = vsource;
+	hr.mIndexCount = icount;
+	hr.mFaceCount  = icount/3;
+	hr.mIndices    = sh.indices;
+	FinishHull(scratch,scratch.ownresults,desc.mFlags,hr,vsource,sources,result);
+	result.mPrefilterRatio = 0;
+	result.mHullError      = error;
+}
+
+// Builds the hull of the vcount cleaned up points in vsource with the small engine into
+// result.  Returns false, having changed nothing, when the input is not one it takes.
+static bool SmallHullBuild(HullScratch &scratch,const HullDesc &desc,Real *vsource,const unsigned int *sources,unsigned int vcount,const Real *bmin,const Real *bmax,HullResultT<Real> &result)
+{
+	if ( !smallaccepts(desc,vcount) ) return false;
+
+	SmallHull sh;
+	const real3 *verts = (const real3 *) vsource;
+	if ( !smallstart(sh,verts,(int)vcount,bmin,bmax) ) return false;
+
+	PlaneDistKernel kernel = planedistkernel();
+	for (int h=0; h<sh.newcount; h++) smallfurthest(sh,verts,sh.newface[h],kernel);
+
+	int vlimit = desc.mMaxVertices ? (int) desc.mMaxVertices : sh.count;
+	while ( sh.hullverts < vlimit )
+	{
+		int te = smallpick(sh);
+		if ( te < 0 ) break;
+		int v = sh.vmax[te];
+		if ( !smalladd(sh,verts,te) ) return false;
+		for (int h=0; h<sh.newcount; h++) smallfurthest(sh,verts,sh.newface[h],kernel);
+		smalldone(sh,v);
+	}
+
+	smallfinish(scratch,desc,sh,vsource,sources,vcount,result);
+	return true;
+}
+
+// Up to SMALLHULL_LANES small sets waiting to be hulled side by side.  BuildConvexHull
+// copies each one's cleaned up points in here, its scratch goes on to the next set.
+class SmallLanes
+{
+public:
+	SmallLanes(void) { used = 0; }
+
+	Real               x[SMALLHULL_MAX*SMALLHULL_LANES];     // the points of every set, point i of lane k
+	Real               y[SMALLHULL_MAX*SMALLHULL_LANES];     // at i*SMALLHULL_LANES+k
+	Real               z[SMALLHULL_MAX*SMALLHULL_LANES];
+	Real               bias[SMALLHULL_MAX*SMALLHULL_LANES];  // each lane's SmallHull::bias, -FLT_MAX past its points
+	SmallHull          hull[SMALLHULL_LANES];
+	real3              verts[SMALLHULL_LANES][SMALLHULL_MAX];
+	unsigned int       sources[SMALLHULL_LANES][SMALLHULL_MAX];
+	unsigned int       vcount[SMALLHULL_LANES];
+	Real               bmin[SMALLHULL_LANES][3];
+	Real               bmax[SMALLHULL_LANES][3];
+	size_t             peak[SMALLHULL_LANES];                // the scratch's working set while the set was cleaned up
+	const HullDesc    *desc[SMALLHULL_LANES];
+	HullResultT<Real> *result[SMALLHULL_LANES];
+	HullError         *error[SMALLHULL_LANES];               // filled in by whoever asked for the hull
+	int                used;
+};
+
+// Takes a set the small engine accepts into the next free lane.
+static void smallqueue(SmallLanes &lanes,const HullDesc &desc,const Real *vsource,const unsigned int *sources,unsigned int vcount,const Real *bmin,const Real *bmax,size_t peak,HullResultT<Real> &result)
+{
+	int k = lanes.used++;
+	const real3 *verts = (const real3 *) vsource;
+	for (unsigned int i=0; i<vcount; i++)
+	{
+		lanes.verts[k][i]   = verts[i];
+		lanes.sources[k][i] = sources[i];
+	}
+	lanes.vcount[k] = vcount;
+	for (int j=0; j<3; j++)
+	{
+		lanes.bmin[k][j] = bmin[j];
+		lanes.bmax[k][j] = bmax[j];
+	}
+	lanes.peak[k]   = peak;
+	lanes.desc[k]   = &desc;
+	lanes.result[k] = &result;
+	lanes.error[k]  = NULL;
+}
+
+// Does the work of CreateConvexHull, and of CreateConvexHullLODs when budgets is set:
+// then the hull is built once, up to the largest budget, and results[i] gets the hull
+// as it stood with budgets[i] vertices.
+static HullError BuildConvexHull(HullScratch &scratch,const HullDesc &desc,const unsigned int *budgets,unsigned int count,HullResultT<Real> *results,SmallLanes *lanes=NULL)
+{
+	HullError ret = QE_FAIL;
+
+
+	PHullResult hr;
+	HullContext &hc = scratch.hc;
+	hc.Reset();
+	hc.conflictlists = desc.HasHullFlag(QF_CONFLICT_LISTS);
+	hc.exact         = desc.HasHullFlag(QF_EXACT_PREDICATES);
+	hc.tolerance         = (Real) desc.mTolerance;
+	hc.relativetolerance = (Real) desc.mRelativeTolerance;
+	hc.cancel            = desc.mCancel;
+	if ( desc.mTimeLimit > 0 )
+	{
+		hc.timed    = true;
+		hc.deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(desc.mTimeLimit));
+	}
+#if HULL_THREADS
+	if ( desc.HasHullFlag(QF_PARALLEL) )
+	{
+		hc.threads = HullTaskPool::Get().ThreadCount();
+		if ( desc.mMaxThreads && (int)desc.mMaxThreads < hc.threads ) hc.threads = desc.mMaxThreads;
+	}
+#endif
+
+	unsigned int vcount = desc.mVcount;
+	if ( vcount < 8 ) vcount = 8;
+
+	Real scale[3] = {1,1,1};
+
+	HullBounds bounds;
+	if ( desc.mVcount ) HullVertexReader(desc).Bounds(desc.mVcount,bounds);
+
+	// QF_LOW_MEMORY cleans packed doubles up in the caller's array (see HullDesc::mVertices)
+	bool lean = desc.HasHullFlag(QF_LOW_MEMORY);
+	Real *inplace = NULL;
+#if !HULL_REAL_FLOAT
+	if ( lean && !desc.mComponents[0] && desc.mVertexFormat == QV_DOUBLE && desc.mVcount >= 8 &&
+	     (desc.mVertexStride == 0 || desc.mVertexStride == sizeof(double)*3) ) inplace = desc.mVertices;
+#endif
+
+	// QF_CORESET meets the tolerance by hulling only the points that can decide it
+	Real coreerror = 0;
+	unsigned int corecount = 0;
+	if ( desc.HasHullFlag(QF_CORESET) && desc.mVcount )
+	{
+		Real dx = bounds.bmax[0]-bounds.bmin[0];
+		Real dy = bounds.bmax[1]-bounds.bmin[1];
+		Real dz = bounds.bmax[2]-bounds.bmin[2];
+		Real diagonal = sqrt(dx*dx+dy*dy+dz*dz);
+		coreerror = Max((Real)desc.mTolerance,(Real)desc.mRelativeTolerance*diagonal);
+		coreerror -= diagonal*0.001f; // calchullgen stops short of the coreset's hull by its epsilon, leave it that much
+	}
+
+	bool ok = true;
+	unsigned int ovcount = PlanarPrism(desc,bounds,scratch);
+	Real *vsource = scratch.vsource.element;
+	bool planar = (ovcount != 0); // a flat input is hulled in its plane, vsource has the slab around that outline
+	if ( !planar )
+	{
+		if ( coreerror > 0 ) corecount = Coreset(desc,bounds,coreerror,scratch);
+		const unsigned int *subset = corecount ? scratch.coreset.element : NULL;
+		if ( subset )
+		{
+			vcount = Max(corecount,8u);
+			hc.tolerance = hc.relativetolerance = 0; // the coreset takes the rest of the budget
+		}
+		if ( !inplace ) scratch.vsource.Resize(vcount*3);
+		vsource = inplace ? inplace : scratch.vsource.element;
+		scratch.sources.Resize(vcount);
+		ok = CleanupVertices(desc, bounds, ovcount, vsource, scratch.sources.element, desc.mNormalEpsilon, scale, scratch.weldheads, scratch.weldnext, lean, subset, corecount ); // normalize point cloud, remove duplicates!
+	}
+
+	unsigned int *sources = scratch.sources.element; // input index of each vsource point
+
+	// the most the scratch held at once, sampled before each step that lets go of some of it
+	size_t peak = scratch.WorkingSet();
+	if ( lean )
+	{
+		scratch.weldheads.SetSize(0);
+		scratch.weldnext.SetSize(0);
+		scratch.planar.SetSize(0);
+		scratch.outline.SetSize(0);
+		scratch.column.SetSize(0);
+		scratch.height.SetSize(0);
+		scratch.corekept.Release();
+		scratch.coreset.SetSize(0);
+	}
+
+	if ( ok )
+	{
+    Real bmin[3];
+    Real bmax[3];
+
+
+		if ( 1 ) // scale vertices back to their original size, boxing them on the way.
+		{
+			Real sx = scale[0], sy = scale[1], sz = scale[2];
+			Real minx = FLT_MAX, miny = FLT_MAX, minz = FLT_MAX;
+			Real maxx = -FLT_MAX, maxy = -FLT_MAX, maxz = -FLT_MAX;
+			Real *v = vsource;
+			for (unsigned int i=0; i<ovcount; i++, v+=3)
+			{
+				Real x = v[0]*sx;
+				Real y = v[1]*sy;
+				Real z = v[2]*sz;
+				v[0] = x;
+				v[1] = y;
+				v[2] = z;
+				minx = Min(minx,x); maxx = Max(maxx,x);
+				miny = Min(miny,y); maxy = Max(maxy,y);
+				minz = Min(minz,z); maxz = Max(maxz,z);
+			}
+			bmin[0] = minx; bmin[1] = miny; bmin[2] = minz;
+			bmax[0] = maxx; bmax[1] = maxy; bmax[2] = maxz;
+		}
+
+		Real skinwidth = 0;
+
+		if ( desc.HasHullFlag(QF_SKIN_WIDTH) )
+    {
+			skinwidth = desc.mSkinWidth;
+      if ( skinwidth < 0 ) // if it is a negative skinwidth we shrink the hull points relative to the center.
+      {
+        Real center[3];
+
+        center[0] = (bmax[0] - bmin[0])*0.5f + bmin[0];
+        center[1] = (bmax[1] - bmin[1])*0.5f + bmin[1];
+        center[2] = (bmax[2] - bmin[2])*0.5f + bmin[2];
+
+        Real dx = (bmax[0]-bmin[0])*0.5f;
+        Real dy = (bmax[1]-bmin[1])*0.5f;
+        Real dz = (bmax[2]-bmin[2])*0.5f;
+        Real dist = sqrt(dx*dx+dy*dy+dz*dz);
+
+        skinwidth*=-1; // make it positive...
+
+        Real scale = 1.0f - (skinwidth/dist);
+        if ( scale < 0.3f ) scale = 0.3f;
+   			for (unsigned int i=0; i<ovcount; i++)
+  			{
+ 	  			Real *v = &vsource[i*3];
+
+          v[0]-=center[0];
+          v[1]-=center[1];
+          v[2]-=center[2];
+
+          v[0]*=scale;
+          v[1]*=scale;
+          v[2]*=scale;
+
+          v[0]+=center[0];
+          v[1]+=center[1];
+          v[2]+=center[2];
+        }
+        skinwidth = 0;
+      }
+    }
+
+		// the slab is its own hull, the 3D build only sees it when a limit or skin width has to be met
+		if ( planar && !budgets && skinwidth == 0 && (desc.mMaxVertices == 0 || desc.mMaxVertices >= ovcount) )
+		{
+			PrismHull(scratch,desc,vsource,sources,ovcount,results[0]);
+			results[0].mWorkingSet = Max(peak,scratch.WorkingSet());
+			return QE_OK;
+		}
+
+		if ( desc.HasHullFlag(QF_SPATIAL_ORDER) ) SpatialOrder(scratch,vsource,ovcount,bmin,bmax);
+
+		// a handful of points is hulled on the stack, whatever the small engine turns down goes on as usual
+		if ( desc.HasHullFlag(QF_SMALL_INPUT) && !budgets )
+		{
+			if ( lanes && smallaccepts(desc,ovcount) )
+			{
+				// hulled with others in SmallLanesBuild
+				smallqueue(*lanes,desc,vsource,sources,ovcount,bmin,bmax,Max(peak,scratch.WorkingSet()),results[0]);
+				return QE_OK;
+			}
+			if ( SmallHullBuild(scratch,desc,vsource,sources,ovcount,bmin,bmax,results[0]) )
+			{
+				results[0].mWorkingSet = Max(peak,scratch.WorkingSet()) + sizeof(SmallHull);
+				return QE_OK;
+			}
+		}
+
+		double prefilterratio = 0;
+		if ( desc.HasHullFlag(QF_PREFILTER) && ovcount )
+		{
+			unsigned int kept = prefilter(scratch,vsource,sources,ovcount);
+			prefilterratio = (double)(ovcount-kept)/(double)ovcount;
+			ovcount = kept;
+		}
+
+		if ( desc.mHintIndices && desc.mHintCount )
+		{
+			// hints name input points, the hull works on what is left of them after cleanup
+			Array<int> &where = scratch.where;
+			where.Resize(desc.mVcount);
+			for (unsigned int i=0; i<desc.mVcount; i++) where[i] = -1;
+			for (unsigned int i=0; i<ovcount; i++)
+			{
+				if ( sources[i] != HULL_NO_SOURCE ) where[sources[i]] = i;
+			}
+			for (unsigned int i=0; i<desc.mHintCount; i++)
+			{
+				unsigned int h = desc.mHintIndices[i];
+				if ( h < desc.mVcount && where[h] >= 0 ) hc.hints.Add(where[h]);
+			}
+		}
+
+		unsigned int vlimit = desc.mMaxVertices;
+		if ( budgets )
+		{
+			hc.hints.count = 0; // a warm start adds the vertices in another order
+			vlimit = 1;
+			for (unsigned int i=0; i<count; i++)
+			{
+				hc.lodbudgets.Add(budgets[i]);
+				hc.lodstart.Add(-1);
+				hc.lodcount.Add(0);
+				hc.loderror.Add(0);
+				if ( vlimit && (budgets[i] == 0 || budgets[i] > vlimit) ) vlimit = budgets[i]; // 0 is no limit
+			}
+		}
+
+		ok = ComputeHull(hc,ovcount,vsource,hr,vlimit,skinwidth);
+
+		peak = Max(peak,scratch.WorkingSet());
+		if ( lean )
+		{
+			// per point state of the hull, all of it done with
+			hc.isextreme.Release();
+			hc.allow.SetSize(0);
+			hc.conflictnext.SetSize(0);
+			hc.pending.SetSize(0);
+			hc.owner.SetSize(0);
+			hc.ownerrise.SetSize(0);
+			scratch.morton.SetSize(0);
+			scratch.keep.SetSize(0);
+			scratch.where.SetSize(0);
+		}
+
+		if ( ok )
+		{
+			ret = QE_OK;
+
+			if ( budgets )
+			{
+				for (unsigned int i=0; i<count; i++)
+				{
+					PHullResult lod;
+					lod.mVcount     = ovcount;
+					lod.mVertices   = vsource;
+					lod.mIndexCount = hc.lodcount[i];
+					lod.mFaceCount  = hc.lodcount[i]/3;
+					lod.mIndices    = (unsigned int *) &hc.lodtris[hc.lodstart[i]];
+					FinishHull(scratch,false,desc.mFlags,lod,vsource,sources,results[i]);
+					results[i].mPrefilterRatio = prefilterratio;
+					results[i].mHullError      = hc.loderror[i] + (corecount ? coreerror : 0);
+				}
+			}
+			else
+			{
+				FinishHull(scratch,scratch.ownresults,desc.mFlags,hr,vsource,sources,results[0]);
+				results[0].mPrefilterRatio = prefilterratio;
+				results[0].mHullError      = hc.error + (corecount ? coreerror : 0);
+			}
+
+			peak = Max(peak,scratch.WorkingSet());
+			for (unsigned int i=0; i<(budgets ? count : 1); i++) results[i].mWorkingSet = peak;
+
+			// ReleaseHull frees memory for hr.mVertices and hr.mIndices, which can be the
+			// scratch copy of the points and calchull's answer, so be sure to set them to NULL then
+			if ( hr.mVertices == vsource) hr.mVertices = NULL;
+			if ( hr.mIndices == (unsigned int *) hc.hullindices.element ) hr.mIndices = NULL;
+
+			ReleaseHull(hr);
+		}
+	}
+
+	return ret;
+}
+
+static HullError CreateConvexHull(const HullDesc       &desc,           // describes the input request
+																				HullResultT<Real>    &result)         // contains the resulst
+{
+	HullScratch scratch;
+	return BuildConvexHull(scratch,desc,NULL,0,&result);
+}
+
+// Hulls the sets queued in lanes side by side and empties it.  Every lane takes the same
+// steps as SmallHullBuild, and each pass of the kernel measures the next new face of every
+// set at once: a set with all of its new faces measured first adds its next point.  A set
+// the small engine turns down part way is built again on its own, by the general build.
+static void SmallLanesBuild(HullScratch &scratch,SmallLanes &lanes)
+{
+	bool live[SMALLHULL_LANES];   // still adding points
+	bool ok[SMALLHULL_LANES];     // not turned down
+	int  vlimit[SMALLHULL_LANES];
+	int  added[SMALLHULL_LANES];  // the point the faces being measured were made for, -1 for the simplex
+	int  next[SMALLHULL_LANES];   // the next of newface to measure
+	int  count = 0;
+	for (int k=0; k<SMALLHULL_LANES; k++)
+	{
+		SmallHull &sh = lanes.hull[k];
+		live[k]  = (k < lanes.used) && smallstart(sh,lanes.verts[k],(int)lanes.vcount[k],lanes.bmin[k],lanes.bmax[k]);
+		ok[k]    = live[k];
+		added[k] = -1;
+		next[k]  = 0;
+		if ( !live[k] ) continue;
+		vlimit[k] = lanes.desc[k]->mMaxVertices ? (int) lanes.desc[k]->mMaxVertices : sh.count;
+		count     = Max(count,sh.count);
+	}
+	for (int i=0; i<count; i++)
+	{
+		for (int k=0; k<SMALLHULL_LANES; k++)
+		{
+			bool in = live[k] && i < lanes.hull[k].count;
+			int  j  = i*SMALLHULL_LANES+k;
+			lanes.x[j]    = in ? lanes.verts[k][i].x : 0;
+			lanes.y[j]    = in ? lanes.verts[k][i].y : 0;
+			lanes.z[j]    = in ? lanes.verts[k][i].z : 0;
+			lanes.bias[j] = in ? lanes.hull[k].bias[i] : -FLT_MAX;
+		}
+	}
+
+	LaneDistKernel kernel = lanedistkernel();
+	LaneQuery q;
+	int face[SMALLHULL_LANES];
+	for (;;)
+	{
+		bool any = false;
+		for (int k=0; k<SMALLHULL_LANES; k++)
+		{
+			SmallHull &sh = lanes.hull[k];
+			if ( live[k] && next[k] == sh.newcount )
+			{
+				if ( added[k] >= 0 ) smalldone(sh,added[k]);
+				int te = (sh.hullverts < vlimit[k]) ? smallpick(sh) : -1;
+				if ( te < 0 )
+				{
+					live[k] = false;
+				}
+				else
+				{
+					added[k] = sh.vmax[te];
+					next[k]  = 0;
+					if ( smalladd(sh,lanes.verts[k],te) ) lanes.bias[added[k]*SMALLHULL_LANES+k] = -FLT_MAX;
+					else live[k] = ok[k] = false;
+				}
+			}
+			face[k] = live[k] ? sh.newface[next[k]++] : -1;
+			real3 o(0,0,0), n(0,0,0);  // a lane with nothing to ask measures nothing
+			if ( face[k] >= 0 )
+			{
+				o   = lanes.verts[k][sh.face[face[k]][0]];
+				n   = sh.normal[face[k]];
+				any = true;
+			}
+			q.ox[k] = o.x; q.oy[k] = o.y; q.oz[k] = o.z;
+			q.nx[k] = n.x; q.ny[k] = n.y; q.nz[k] = n.z;
+		}
+		if ( !any ) break;
+		kernel(lanes.x,lanes.y,lanes.z,lanes.bias,count,q);
+		for (int k=0; k<SMALLHULL_LANES; k++)
+		{
+			if ( face[k] < 0 ) continue;
+			SmallHull &sh = lanes.hull[k];
+			bool none = (lanes.bias[q.m[k]*SMALLHULL_LANES+k] != 0);
+			sh.vmax[face[k]] = none ? -1 : q.m[k];
+			sh.rise[face[k]] = none ? 0 : q.dm[k];
+		}
+	}
+
+	for (int k=0; k<lanes.used; k++)
+	{
+		if ( ok[k] )
+		{
+			smallfinish(scratch,*lanes.desc[k],lanes.hull[k],(Real *)lanes.verts[k],lanes.sources[k],lanes.vcount[k],*lanes.result[k]);
+			lanes.result[k]->mWorkingSet = Max(lanes.peak[k],scratch.WorkingSet()) + sizeof(SmallLanes);
+			*lanes.error[k] = QE_OK;
+		}
+		else
+		{
+			*lanes.error[k] = BuildConvexHull(scratch,*lanes.desc[k],NULL,0,lanes.result[k]);
+		}
+	}
+	lanes.used = 0;
+}
+
+// Builds desc into result, or leaves it in lanes to be hulled alongside others.
+static void batchbuild(HullScratch &scratch,SmallLanes *lanes,const HullDesc &desc,HullResultT<Real> &result,HullError &error)
+{
+	int queued = lanes ? lanes->used : 0;
+	error = BuildConvexHull(scratch,desc,NULL,0,&result,lanes);
+	if ( lanes && lanes->used > queued )
+	{
+		lanes->error[queued] = &error;
+		if ( lanes->used == SMALLHULL_LANES ) SmallLanesBuild(scratch,*lanes);
+	}
+}
+
+// CreateConvexHulls hands the hulls out largest first, by input point count, so that
+// the long ones start early and the short ones fill in the gaps at the end.
+class BatchEntry
+{
+public:
+	unsigned int vcount;
+	unsigned int index;
+};
+
+static int batchcompare(const void *a,const void *b)
+{
+	const BatchEntry *ea = (const BatchEntry *) a;
+	const BatchEntry *eb = (const BatchEntry *) b;
+	if ( ea->vcount != eb->vcount ) return (ea->vcount > eb->vcount) ? -1 : 1;
+	return (ea->index < eb->index) ? -1 : (ea->index > eb->index) ? 1 : 0;
+}
+
+#if HULL_THREADS
+// One task per thread of the pool, each with its own scratch.  A task keeps taking
+// the next hull in line until there are none left, so a thread that drew small
+// hulls simply gets through more of them.
+class BatchJob
+{
+public:
+	const HullDesc            *descs;
+	HullResultT<Real>         *results;
+	HullError                 *errors;
+	const BatchEntry          *order;
+	unsigned int               count;
+	std::atomic<unsigned int>  next;      // the next entry of order to be built
+	HullScratch               *scratch;   // one per task
+	SmallLanes                *lanes;     // one per task with QF_SMALL_INPUT, else NULL
+};
+
+static void batchtask(void *data,int task,int,int)
+{
+	BatchJob *job = (BatchJob *) data;
+	HullScratch &scratch = job->scratch[task];
+	SmallLanes *lanes = job->lanes ? &job->lanes[task] : NULL;
+	for (;;)
+	{
+		unsigned int k = job->next.fetch_add(1);
+		if ( k >= job->count ) break;
+		unsigned int i = job->order[k].index;
+		batchbuild(scratch,lanes,job->descs[i],job->results[i],job->errors[i]);
+	}
+	if ( lanes && lanes->used ) SmallLanesBuild(scratch,*lanes);
+}
+#endif
+
+static HullError CreateConvexHulls(const HullDesc *descs,unsigned int count,HullResultT<Real> *results,HullError *errors)
+{
+	Array<HullError> status;
+	if ( !errors )
+	{
+		status.SetSize(count ? count : 1);
+		errors = status.element;
+	}
+
+	Array<BatchEntry> order;
+	order.SetSize(count ? count : 1);
+	bool small = false;  // QF_SMALL_INPUT sets are hulled several at a time, see SmallLanes
+	for (unsigned int i=0; i<count; i++)
+	{
+		order[i].vcount = descs[i].mVcount;
+		order[i].index  = i;
+		errors[i]       = QE_FAIL;
+		if ( descs[i].HasHullFlag(QF_SMALL_INPUT) ) small = true;
+	}
+	qsort(order.element,count,sizeof(BatchEntry),batchcompare);
+
+#if HULL_THREADS
+	int tasks = HullTaskPool::Get().ThreadCount();
+	if ( tasks > (int)count ) tasks = (int)count;
+	if ( tasks > 1 )
+	{
+		HullScratch *scratch = new HullScratch[tasks];
+		SmallLanes  *lanes   = small ? new SmallLanes[tasks] : NULL;
+		BatchJob job;
+		job.descs   = descs;
+		job.results = results;
+		job.errors  = errors;
+		job.order   = order.element;
+		job.count   = count;
+		job.next    = 0;
+		job.scratch = scratch;
+		job.lanes   = lanes;
+		HullTaskPool::Get().ParallelFor(tasks,tasks,batchtask,&job);
+		delete []scratch;
+		delete []lanes;
+	}
+	else
+#endif
+	{
+		HullScratch scratch;
+		SmallLanes *lanes = small ? new SmallLanes : NULL;
+		for (unsigned int k=0; k<count; k++)
+		{
+			unsigned int i = order[k].index;
+			batchbuild(scratch,lanes,descs[i],results[i],errors[i]);
+		}
+		if ( lanes && lanes->used ) SmallLanesBuild(scratch,*lanes);
+		delete lanes;
+	}
+
+	HullError ret = QE_OK;
+	for (unsigned int i=0; i<count; i++)
+	{
+		if ( errors[i] != QE_OK ) ret = QE_FAIL;
+	}
+	return ret;
+}
+
+// What a HullFuture points at.  stage only moves forward while a hull is asked for,
+// and every change of it is made under lock and announced on done.
+enum AsyncStage
+{
+	ASYNC_IDLE,      // no hull asked for yet
+	ASYNC_QUEUED,    // waiting for a thread of the HullAsyncPool
+	ASYNC_RUNNING,
+	ASYNC_READY,     // result and error are set, the callback may be running
+	ASYNC_DONE
+};
+
+class AsyncState
+{
+public:
+	AsyncState(void)
+	{
+		stage    = ASYNC_IDLE;
+		error    = QE_FAIL;
+		cancel   = 0;
+		callback = NULL;
+		user     = NULL;
+		future   = NULL;
+	}
+
+	HullDesc                      desc;      // a copy, the points it points at are still the caller's.
+	HullResultT<Real>             result;
+	HullError                     error;
+	volatile int                  cancel;    // desc.mCancel, unless the caller brought their own
+	HullFutureT<Real>::Callback   callback;
+	void                         *user;
+	HullFutureT<Real>            *future;
+	int                           stage;
+#if HULL_THREADS
+	HullAsyncTask                 task;
+	std::mutex                    lock;
+	std::condition_variable       done;
+#endif
+};
+
+static void setstage(AsyncState &s,int stage)
+{
+#if HULL_THREADS
+	std::lock_guard<std::mutex> lock(s.lock);
+	s.stage = stage;
+	s.done.notify_all();
+#else
+	s.stage = stage;
+#endif
+}
+
+static void finishasync(AsyncState &s,HullError error)
+{
+	s.error = error;
+	setstage(s,ASYNC_READY);
+	if ( s.callback ) s.callback(*s.future,s.user);
+	setstage(s,ASYNC_DONE); // the future may be gone once this is set
+}
+
+#if HULL_THREADS
+// A worker's scratch, kept from one hull to the next while more are queued and given
+// back once the queue runs dry.
+class AsyncScratch
+{
+public:
+	AsyncScratch(void)  { scratch = NULL; }
+	~AsyncScratch(void) { delete scratch; }
+	HullScratch *scratch;
+};
+
+static thread_local AsyncScratch asyncscratch;
+#endif
+
+static void asynctask(void *data)
+{
+	AsyncState &s = *(AsyncState *) data;
+	setstage(s,ASYNC_RUNNING);
+#if HULL_THREADS
+	HullScratch *&scratch = asyncscratch.scratch;
+	if ( !scratch ) scratch = new HullScratch;
+	HullError error = BuildConvexHull(*scratch,s.desc,NULL,0,&s.result);
+	if ( !HullAsyncPool::Get().Queued() )
+	{
+		delete scratch;
+		scratch = NULL;
+	}
+#else
+	HullScratch scratch;
+	HullError error = BuildConvexHull(scratch,s.desc,NULL,0,&s.result);
+#endif
+	finishasync(s,error);
+}
+
+static HullError CreateConvexHullAsync(const HullDesc &desc,HullFutureT<Real> &future,AsyncState &s,HullPriority priority,
+                                       HullFutureT<Real>::Callback callback,void *user)
+{
+#if HULL_THREADS
+	std::lock_guard<std::mutex> lock(s.lock);
+#endif
+	if ( s.stage != ASYNC_IDLE && s.stage != ASYNC_DONE ) return QE_FAIL;
+	s.desc     = desc;
+	s.cancel   = 0;
+	if ( !desc.mCancel ) s.desc.mCancel = &s.cancel;
+	ReleaseResult(s.result); // the last hull, unless the caller already let go of it through GetResult
+	s.result   = HullResultT<Real>();
+	s.error    = QE_FAIL;
+	s.callback = callback;
+	s.user     = user;
+	s.future   = &future;
+	s.stage    = ASYNC_QUEUED;
+#if HULL_THREADS
+	s.task.func     = asynctask;
+	s.task.data     = &s;
+	s.task.priority = (priority < QP_LOW) ? QP_LOW : (priority > QP_HIGH) ? QP_HIGH : priority;
+	HullAsyncPool::Get().Submit(&s.task);
+	return QE_OK;
+#else
+	(void) priority;
+	asynctask(&s); // no threads, so the hull is ready by the time this returns
+	return QE_OK;
+#endif
+}
+
+// Returns whether the hull was still queued or being built, and so not handed out yet.
+static bool CancelAsync(AsyncState &s)
+{
+#if HULL_THREADS
+	{
+		std::lock_guard<std::mutex> lock(s.lock);
+		if ( s.stage != ASYNC_QUEUED && s.stage != ASYNC_RUNNING ) return false;
+		if ( s.stage != ASYNC_QUEUED || !HullAsyncPool::Get().Remove(&s.task) )
+		{
+			s.cancel = 1;  // a worker has it, let the build stop itself
+			return true;
+		}
+	}
+	finishasync(s,QE_FAIL);
+	return true;
+#else
+	(void) s;
+	return false;
+#endif
+}
+
+// Blocks until the hull is at least at 'stage'.  Returns false if none was asked for.
+static bool waitasync(AsyncState &s,int stage)
+{
+#if HULL_THREADS
+	std::unique_lock<std::mutex> lock(s.lock);
+	while ( s.stage != ASYNC_IDLE && s.stage < stage ) s.done.wait(lock);
+#else
+	(void) stage;
+#endif
+	return s.stage != ASYNC_IDLE;
+}
+
+static HullError CreateConvexHullLODs(const HullDesc &desc,const unsigned int *budgets,unsigned int count,HullResultT<Real> *results)
+{
+	if ( desc.HasHullFlag(QF_SKIN_WIDTH) )
+	{
+		// the skin is built from the finished hull's planes, so every budget needs a hull of its own
+		HullDesc lod(desc);
+		for (unsigned int i=0; i<count; i++)
+		{
+			lod.mMaxVertices = budgets[i];
+			if ( CreateConvexHull(lod,results[i]) != QE_OK )
+			{
+				while ( i-- ) ReleaseResult(results[i]);
+				return QE_FAIL;
+			}
+		}
+		return QE_OK;
+	}
+	HullScratch scratch;
+	return BuildConvexHull(scratch,desc,budgets,count,results);
+}
+
+
+
+static HullError ReleaseResult(HullResultT<Real> &result) // release memory allocated for this result, we are done with it.
+{
+	if ( result.mOutputVertices )
+	{
+		NX_FREE(result.mOutputVertices);
+		result.mOutputVertices = 0;
+	}
+	if ( result.mIndices )
+	{
+		NX_FREE(result.mIndices);
+		result.mIndices = 0;
+	}
+	if ( result.mOutputSources )
+	{
+		NX_FREE(result.mOutputSources);
+		result.mOutputSources = 0;
+	}
+	return QE_OK;
+}
+
+
+static void AddPoint(unsigned int &vcount,Real *p,Real x,Real y,Real z)
+{
+	Real *dest = &p[vcount*3];
+	dest[0] = x;
+	dest[1] = y;
+	dest[2] = z;
+	vcount++;
+}
+
+
+Real GetDist(Real px,Real py,Real pz,const Real *p2)
+{
+
+	Real dx = px - p2[0];
+	Real dy = py - p2[1];
+	Real dz = pz - p2[2];
+
+	return dx*dx+dy*dy+dz*dz;
+}
+
+
+
+// Reads the input positions of a HullDesc where they are, in whichever layout
+// and precision the caller handed them to us, so they never need to be copied.
+// Duplicate removal hashes the kept vertices on a grid of normalepsilon sized cells, so a
+// point that is within normalepsilon of one of them (on every axis) finds it in its own
+// cell or one of the 26 around it.  As with the plain scan it replaces, a point is welded
+// to the earliest kept vertex it is close to, and that vertex moves to whichever of the
+// two is further from the center, changing cell with it.  A cloud of a few dozen points
+// is done quicker with the plain scan itself than with 27 cells per point.
+#define WELD_SCAN 32  // most input points welded with the plain scan
+
+static void weldcell(Real normalepsilon,const Real *p,long long *cell)
+{
+	for (int j=0; j<3; j++) cell[j] = (long long) floor( (double)p[j]/(double)normalepsilon );
+}
+
+static unsigned int weldbucket(const long long *cell,unsigned int mask)
+{
+	unsigned long long h = (unsigned long long)cell[0]*73856093ULL ^ (unsigned long long)cell[1]*19349663ULL ^ (unsigned long long)cell[2]*83492791ULL;
+	return (unsigned int)(h ^ (h>>29)) & mask;
+}
+
+static bool CleanupVertices(const HullDesc &desc,            // the input point cloud, read in place
+																const HullBounds &bounds,   // its bounding box
+																unsigned int &vcount,       // output number of vertices
+																Real *vertices,                 // location to store the results, which may be the input itself (QF_LOW_MEMORY).
+																unsigned int *sources,          // the input index of each result, HULL_NO_SOURCE for made up points.
+																Real  normalepsilon,
+																Real *scale,
+																Array<int> &weldheads,        // scratch for the weld hash
+																Array<int> &weldnext,
+																bool lean,                    // QF_LOW_MEMORY: half the buckets
+																const unsigned int *subset,   // if set, clean up only these input points (ascending, see Coreset)
+																unsigned int subsetcount)
+{
+	unsigned int svcount = subset ? subsetcount : desc.mVcount;
+	if ( svcount == 0 ) return false;
+
+	HullVertexReader src(desc);
+
+
+	#define EPSILON 0.000001f // close enough to consider two doubleing point numbers to be 'the same'.
+
+	bool ret = false;
+
+	vcount = 0;
+
+	Real recip[3];
+
+	if ( scale )
+	{
+		scale[0] = 1;
+		scale[1] = 1;
+		scale[2] = 1;
+	}
+
+	const Real *bmin = bounds.bmin;
+	const Real *bmax = bounds.bmax;
+
+	Real dx = bmax[0] - bmin[0];
+	Real dy = bmax[1] - bmin[1];
+	Real dz = bmax[2] - bmin[2];
+
+	Real center[3];
+
+	center[0] = dx*0.5f + bmin[0];
+	center[1] = dy*0.5f + bmin[1];
+	center[2] = dz*0.5f + bmin[2];
+
+	if ( dx < EPSILON || dy < EPSILON || dz < EPSILON || svcount < 3 )
+	{
+
+		Real len = FLT_MAX;
+
+		if ( dx > EPSILON && dx < len ) len = dx;
+		if ( dy > EPSILON && dy < len ) len = dy;
+		if ( dz > EPSILON && dz < len ) len = dz;
+
+		if ( len == FLT_MAX )
+		{
+			dx = dy = dz = 0.01f; // one centimeter
+		}
+		else
+		{
+			if ( dx < EPSILON ) dx = len * 0.05f; // 1/5th the shortest non-zero edge.
+			if ( dy < EPSILON ) dy = len * 0.05f;
+			if ( dz < EPSILON ) dz = len * 0.05f;
+		}
+
+		Real x1 = center[0] - dx;
+		Real x2 = center[0] + dx;
+
+		Real y1 = center[1] - dy;
+		Real y2 = center[1] + dy;
+
+		Real z1 = center[2] - dz;
+		Real z2 = center[2] + dz;
+
+		AddPoint(vcount,vertices,x1,y1,z1);
+		AddPoint(vcount,vertices,x2,y1,z1);
+		AddPoint(vcount,vertices,x2,y2,z1);
+		AddPoint(vcount,vertices,x1,y2,z1);
+		AddPoint(vcount,vertices,x1,y1,z2);
+		AddPoint(vcount,vertices,x2,y1,z2);
+		AddPoint(vcount,vertices,x2,y2,z2);
+		AddPoint(vcount,vertices,x1,y2,z2);
+		for (unsigned int i=0; i<vcount; i++) sources[i] = HULL_NO_SOURCE;
+
+		return true; // return cube
+
+
+	}
+	else
+	{
+		if ( scale )
+		{
+			scale[0] = dx;
+			scale[1] = dy;
+			scale[2] = dz;
+
+			recip[0] = 1 / dx;
+			recip[1] = 1 / dy;
+			recip[2] = 1 / dz;
+
+			center[0]*=recip[0];
+			center[1]*=recip[1];
+			center[2]*=recip[2];
+
+		}
+
+	}
+
+	unsigned int mask = 0; // 0 when welding with the plain scan
+	if ( normalepsilon > 0 && svcount > WELD_SCAN )
+	{
+		unsigned int buckets = 64;
+		while ( buckets < (lean ? svcount : svcount*2) ) buckets*=2;
+		mask = buckets-1;
+		weldheads.Resize(buckets);
+		memset(weldheads.element,0xFF,sizeof(int)*buckets); // all -1
+		weldnext.Resize(svcount);
+	}
+
+	for (unsigned int k=0; k<svcount; k++)
+	{
+		unsigned int i = subset ? subset[k] : k;
+
+		Real p[3];
+		src.Get(i,p);
+
+		Real px = p[0];
+		Real py = p[1];
+		Real pz = p[2];
+
+		if ( scale )
+		{
+			px = px*recip[0]; // normalize
+			py = py*recip[1]; // normalize
+			pz = pz*recip[2]; // normalize
+		}
+
+		if ( normalepsilon > 0 )
+		{
+			Real q[3] = { px, py, pz };
+			long long cell[3];
+			if ( mask ) weldcell(normalepsilon,q,cell);
+
+			// the earliest kept vertex close enough, in this cell or a neighbouring one
+			int match = -1;
+			for (unsigned int j=0; j<vcount && !mask && match<0; j++)
+			{
+				const Real *v = &vertices[j*3];
+				if ( fabs(v[0]-px) < normalepsilon && fabs(v[1]-py) < normalepsilon && fabs(v[2]-pz) < normalepsilon ) match = j;
+			}
+			for (int n=0; n<27 && mask; n++)
+			{
+				long long c[3] = { cell[0]+n%3-1, cell[1]+(n/3)%3-1, cell[2]+n/9-1 };
+				for (int j=weldheads[weldbucket(c,mask)]; j>=0; j=weldnext[j])
+				{
+					if ( match >= 0 && j > match ) continue;
+					const Real *v = &vertices[j*3];
+					if ( fabs(v[0]-px) < normalepsilon && fabs(v[1]-py) < normalepsilon && fabs(v[2]-pz) < normalepsilon ) match = j;
+				}
+			}
+
+			if ( match >= 0 )
+			{
+				// ok, it is close enough to the old one
+				// now let us see if it is further from the center of the point cloud than the one we already recorded.
+				// in which case we keep this one instead.
+				Real *v = &vertices[match*3];
+
+				Real dist1 = GetDist(px,py,pz,center);
+				Real dist2 = GetDist(v[0],v[1],v[2],center);
+
+				if ( dist1 > dist2 )
+				{
+					long long old[3];
+					if ( mask ) weldcell(normalepsilon,v,old);
+					if ( mask && (old[0] != cell[0] || old[1] != cell[1] || old[2] != cell[2]) )
+					{
+						int *link = &weldheads[weldbucket(old,mask)];
+						while ( *link != match ) link = &weldnext[*link];
+						*link = weldnext[match];
+						unsigned int b = weldbucket(cell,mask);
+						weldnext[match] = weldheads[b];
+						weldheads[b] = match;
+					}
+					v[0] = px;
+					v[1] = py;
+					v[2] = pz;
+					sources[match] = i;
+				}
+				continue;
+			}
+
+			if ( mask )
+			{
+				unsigned int b = weldbucket(cell,mask);
+				weldnext[vcount] = weldheads[b];
+				weldheads[b] = vcount;
+			}
+		}
+
+		Real *dest = &vertices[vcount*3];
+		dest[0] = px;
+		dest[1] = py;
+		dest[2] = pz;
+		sources[vcount] = i;
+		vcount++;
+	}
+
+	// ok..now make sure we didn't prune so many vertices it is now invalid.  Once normalized
+	// the input spans 1 on every axis and welding moves no point by normalepsilon or more, so
+	// unless there are too few of them the kept points can only have collapsed when
+	// normalepsilon is a good part of that span; otherwise they need not be read again.
+	if ( vcount < 3 || !scale || normalepsilon >= 0.25f )
+	{
+		Real bmin[3] = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+		Real bmax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		for (unsigned int i=0; i<vcount; i++)
+		{
+			const Real *p = &vertices[i*3];
+			for (int j=0; j<3; j++)
+			{
+				if ( p[j] < bmin[j] ) bmin[j] = p[j];
+				if ( p[j] > bmax[j] ) bmax[j] = p[j];
+			}
+		}
+
+		Real dx = bmax[0] - bmin[0];
+		Real dy = bmax[1] - bmin[1];
+		Real dz = bmax[2] - bmin[2];
+
+		if ( dx < EPSILON || dy < EPSILON || dz < EPSILON || vcount < 3)
+		{
+			Real cx = dx*0.5f + bmin[0];
+			Real cy = dy*0.5f + bmin[1];
+			Real cz = dz*0.5f + bmin[2];
+
+			Real len = FLT_MAX;
+
+			if ( dx >= EPSILON && dx < len ) len = dx;
+			if ( dy >= EPSILON && dy < len ) len = dy;
+			if ( dz >= EPSILON && dz < len ) len = dz;
+
+			if ( len == FLT_MAX )
+			{
+				dx = dy = dz = 0.01f; // one centimeter
+			}
+			else
+			{
+				if ( dx < EPSILON ) dx = len * 0.05f; // 1/5th the shortest non-zero edge.
+				if ( dy < EPSILON ) dy = len * 0.05f;
+				if ( dz < EPSILON ) dz = len * 0.05f;
+			}
+
+			Real x1 = cx - dx;
+			Real x2 = cx + dx;
+
+			Real y1 = cy - dy;
+			Real y2 = cy + dy;
+
+			Real z1 = cz - dz;
+			Real z2 = cz + dz;
+
+			vcount = 0; // add box
+
+			AddPoint(vcount,vertices,x1,y1,z1);
+			AddPoint(vcount,vertices,x2,y1,z1);
+			AddPoint(vcount,vertices,x2,y2,z1);
+			AddPoint(vcount,vertices,x1,y2,z1);
+			AddPoint(vcount,vertices,x1,y1,z2);
+			AddPoint(vcount,vertices,x2,y1,z2);
+			AddPoint(vcount,vertices,x2,y2,z2);
+			AddPoint(vcount,vertices,x1,y2,z2);
+			for (unsigned int i=0; i<vcount; i++) sources[i] = HULL_NO_SOURCE;
+
+			return true;
+		}
+	}
+
+	return true;
+}
+
+static int planarcompare(const void *a,const void *b)
+{
+	const real2 *pa = &((const PlanarPoint *) a)->p;
+	const real2 *pb = &((const PlanarPoint *) b)->p;
+	if ( pa->x != pb->x ) return (pa->x < pb->x) ? -1 : 1;
+	if ( pa->y != pb->y ) return (pa->y < pb->y) ? -1 : 1;
+	return 0;
+}
+
+static Real planarcross(const real2 &o,const real2 &a,const real2 &b)
+{
+	return (a.x-o.x)*(b.y-o.y) - (a.y-o.y)*(b.x-o.x);
+}
+
+// Planar and nearly planar inputs.  The plane is fitted through three far apart points
+// taken from the input's extremes: both ends of the widest axis and the extreme furthest
+// from the line through them, so a cloud that is not flat is usually turned away within
+// its first few points rather than after whole passes over it.  When every point is within
+// mPlanarTolerance (relative to the size of the cloud) of that plane, its bounds' thinnest
+// axis is taken instead if the points are no thicker across it, and the outline is found
+// with a 2D monotone chain hull and scratch.vsource gets the corners of the slab around it,
+// the bottom ones then the top ones, with scratch.sources the input point under each, and
+// their count is returned.  The slab is mPlanarThickness thick and never thinner than the
+// points themselves are, without it just as thick as they are, and only points that are
+// flat but for rounding get a tenth of their extent.  Otherwise, and for points that are
+// all on a line, it returns 0 and the hull is built in 3D.
+static unsigned int PlanarPrism(const HullDesc &desc,const HullBounds &bounds,HullScratch &scratch)
+{
+	unsigned int vcount = desc.mVcount;
+	if ( vcount < 3 ) return 0;
+
+	HullVertexReader src(desc);
+
+	const Real *bmin = bounds.bmin;
+	const Real *bmax = bounds.bmax;
+	int axis = 0;
+	for (int j=1; j<3; j++)
+	{
+		if ( bmax[j]-bmin[j] > bmax[axis]-bmin[axis] ) axis = j;
+	}
+	Real diagonal = sqrt( (bmax[0]-bmin[0])*(bmax[0]-bmin[0]) + (bmax[1]-bmin[1])*(bmax[1]-bmin[1]) + (bmax[2]-bmin[2])*(bmax[2]-bmin[2]) );
+	if ( diagonal < EPSILON ) return 0;
+
+	// the ends of the widest axis are at least diagonal/sqrt(3) apart, and the third corner
+	// is the axis extreme furthest off the line through them, unless they all hug it
+	real3 p0,p1,p2,p;
+	src.Get(bounds.imin[axis],&p0.x);
+	src.Get(bounds.imax[axis],&p1.x);
+	real3 u = p1-p0;
+	Real ulen = magnitude(u);
+	if ( ulen < EPSILON ) return 0;
+	u = u*(1/ulen);
+	Real best = -1;
+	for (int k=0; k<6; k++)
+	{
+		src.Get(k<3 ? bounds.imin[k] : bounds.imax[k-3],&p.x);
+		real3 r = p-p0;
+		r = r - u*dot(r,u);
+		Real d = dot(r,r);
+		if ( d > best ) { best = d; p2 = p; }
+	}
+	if ( best < ulen*ulen*0.01f )
+	{
+		for (unsigned int i=0; i<vcount; i++)
+		{
+			src.Get(i,&p.x);
+			real3 r = p-p0;
+			r = r - u*dot(r,u);
+			Real d = dot(r,r);
+			if ( d > best ) { best = d; p2 = p; }
+		}
+	}
+	real3 n = cross(u,p2-p0);
+	Real nlen = magnitude(n);
+	if ( nlen < EPSILON*ulen ) return 0; // all on a line
+	n = n*(1/nlen);
+	real3 v = cross(n,u);
+
+	// how far off the plane the points are, giving up as soon as it is too far
+	Real flat = Max((Real)desc.mPlanarTolerance,(Real)EPSILON)*diagonal;
+	Real dmin = 0;
+	Real dmax = 0;
+	for (unsigned int i=0; i<vcount; i++)
+	{
+		src.Get(i,&p.x);
+		Real d = dot(p-p0,n);
+		if ( d < dmin ) dmin = d;
+		if ( d > dmax ) dmax = d;
+		if ( dmax-dmin > flat ) return 0;
+	}
+
+	// three points fit the plane only roughly, a cloud lying along an axis is as thin as its bounds
+	int thin = 0;
+	for (int j=1; j<3; j++)
+	{
+		if ( bmax[j]-bmin[j] < bmax[thin]-bmin[thin] ) thin = j;
+	}
+	if ( thin != axis && bmax[thin]-bmin[thin] <= dmax-dmin )
+	{
+		n = real3(0,0,0);
+		u = real3(0,0,0);
+		n[thin] = 1;
+		u[axis] = 1;
+		v = cross(n,u);
+		dmin = bmin[thin]-p0[thin];
+		dmax = bmax[thin]-p0[thin];
+	}
+
+	Array<PlanarPoint> &pts = scratch.planar;
+	pts.Resize(vcount);
+	for (unsigned int i=0; i<vcount; i++)
+	{
+		src.Get(i,&p.x);
+		real3 r = p-p0;
+		pts[i].p      = real2(dot(r,u),dot(r,v));
+		pts[i].source = i;
+	}
+
+	// Andrew's monotone chain, lower then upper, counterclockwise about n
+	qsort(pts.element,vcount,sizeof(PlanarPoint),planarcompare);
+	Array<PlanarPoint> &hull = scratch.outline;
+	hull.Resize(vcount*2);
+	int k = 0;
+	for (unsigned int i=0; i<vcount; i++)
+	{
+		while ( k >= 2 && planarcross(hull[k-2].p,hull[k-1].p,pts[i].p) <= 0 ) k--;
+		hull[k++] = pts[i];
+	}
+	for (int i=(int)vcount-2, lower=k+1; i>=0; i--)
+	{
+		while ( k >= lower && planarcross(hull[k-2].p,hull[k-1].p,pts[i].p) <= 0 ) k--;
+		hull[k++] = pts[i];
+	}
+	k--; // the last point is the first one again
+	if ( k < 3 ) return 0;
+
+	Real half = (Real) desc.mPlanarThickness*0.5f;
+	if ( half <= 0 && dmax-dmin <= EPSILON*diagonal )
+	{
+		Real xmin = FLT_MAX, xmax = -FLT_MAX, ymin = FLT_MAX, ymax = -FLT_MAX;
+		for (int i=0; i<k; i++)
+		{
+			xmin = Min(xmin,hull[i].p.x); xmax = Max(xmax,hull[i].p.x);
+			ymin = Min(ymin,hull[i].p.y); ymax = Max(ymax,hull[i].p.y);
+		}
+		half = Min(xmax-xmin,ymax-ymin)*0.05f; // like the box CleanupVertices falls back on
+	}
+	half = Max(half,(dmax-dmin)*0.5f);
+	Real mid = (dmin+dmax)*0.5f;
+
+	Array<Real> &prism = scratch.vsource;
+	prism.Resize(k*2*3);
+	scratch.sources.Resize(k*2);
+	for (int s=0; s<2; s++)
+	{
+		real3 offset = n*(s ? mid+half : mid-half);
+		for (int i=0; i<k; i++)
+		{
+			real3 q = p0 + u*hull[i].p.x + v*hull[i].p.y + offset;
+			Real *dest = &prism[(s*k+i)*3];
+			dest[0] = q.x;
+			dest[1] = q.y;
+			dest[2] = q.z;
+			scratch.sources[s*k+i] = hull[i].source;
+		}
+	}
+	return k*2;
+}
+
+// Hands the slab PlanarPrism left in vsource, its k bottom corners then its k top ones, on
+// to FinishHull as it is: both caps fanned out from their first corner and two triangles
+// up each side.  Every point is inside the slab, so nothing is outside the hull.
+static void PrismHull(HullScratch &scratch,const HullDesc &desc,Real *vsource,const unsigned int *sources,unsigned int vcount,HullResultT<Real> &result)
+{
+	int k = (int) vcount/2;
+	Array<int> &tris = scratch.hc.hullindices;
+	tris.count = 0;
+	for (int i=1; i+1<k; i++)
+	{
+		tris.Add(0);   tris.Add(i+1);   tris.Add(i);     // bottom, facing -n
+		tris.Add(k);   tris.Add(k+i);   tris.Add(k+i+1); // top, facing n
+	}
+	for (int i=0; i<k; i++)
+	{
+		int j = (i+1)%k;
+		tris.Add(i);   tris.Add(j);     tris.Add(k+j);
+		tris.Add(i);   tris.Add(k+j);   tris.Add(k+i);
+	}
+
+	PHullResult hr;
+	hr.mVcount     = vcount;
+	hr.mVertices   = vsource;
+	hr.mIndexCount = tris.count;
+	hr.mFaceCount  = tris.count/3;
+	hr.mIndices    = (unsigned int *) tris.element;
+	FinishHull(scratch,scratch.ownresults,desc.mFlags,hr,vsource,sources,result);
+	result.mPrefilterRatio = 0;
+	result.mHullError      = 0;
+}
+
+static void BringOutYourDead(const Real *verts,unsigned int vcount, Real *overts,unsigned int &ocount,unsigned int *indices,unsigned indexcount,unsigned int *oindex,Array<unsigned int> &used)
+{
+	used.Resize(vcount);
+	if ( vcount ) memset(used.element,0,sizeof(unsigned int)*vcount);
+
+	ocount = 0;
+
+	for (unsigned int i=0; i<indexcount; i++)
+	{
+		unsigned int v = indices[i]; // original array index
+
+		assert( v >= 0 && v < vcount );
+
+		if ( used[v] ) // if already remapped
+		{
+			indices[i] = used[v]-1; // index to new array
+		}
+		else
+		{
+
+			indices[i] = ocount;      // new index mapping
+
+			overts[ocount*3+0] = verts[v*3+0]; // copy old vert to new vert array
+			overts[ocount*3+1] = verts[v*3+1];
+			overts[ocount*3+2] = verts[v*3+2];
+			if ( oindex ) oindex[ocount] = v; // where it came from
+
+			ocount++; // increment output vert count
+
+			assert( ocount >=0 && ocount <= vcount );
+
+			used[v] = ocount; // assign new index remapping
+		}
+	}
+}
+
+
+//==================================================================================
+static HullError CreateTriangleMesh(HullResultT<Real> &answer,ConvexHullTriangleInterface *iface)
+{
+	HullError ret = QE_FAIL;
+
+
+	const Real *p            = answer.mOutputVertices;
+	const unsigned int   *idx = answer.mIndices;
+	unsigned int fcount       = answer.mNumFaces;
+
+	if ( p && idx && fcount )
+	{
+		ret = QE_OK;
+
+		for (unsigned int i=0; i<fcount; i++)
+		{
+			unsigned int pcount = *idx++;
+
+			unsigned int i1 = *idx++;
+			unsigned int i2 = *idx++;
+			unsigned int i3 = *idx++;
+
+			const Real *p1 = &p[i1*3];
+			const Real *p2 = &p[i2*3];
+			const Real *p3 = &p[i3*3];
+
+			AddConvexTriangle(iface,p1,p2,p3);
+
+			pcount-=3;
+			while ( pcount )
+			{
+				i3 = *idx++;
+				p2 = p3;
+				p3 = &p[i3*3];
+
+				AddConvexTriangle(iface,p1,p2,p3);
+				pcount--;
+			}
+
+		}
+	}
+
+	return ret;
+}
+
+//==================================================================================
+static void AddConvexTriangle(ConvexHullTriangleInterface *callback,const Real *p1,const Real *p2,const Real *p3)
+{
+	ConvexHullVertex v1,v2,v3;
+
+	#define TSCALE1 (1.0f/4.0f)
+
+	v1.mPos[0] = p1[0];
+	v1.mPos[1] = p1[1];
+	v1.mPos[2] = p1[2];
+
+	v2.mPos[0] = p2[0];
+	v2.mPos[1] = p2[1];
+	v2.mPos[2] = p2[2];
+
+	v3.mPos[0] = p3[0];
+	v3.mPos[1] = p3[1];
+	v3.mPos[2] = p3[2];
+
+	Real n[3];
+	ComputeNormal(n,p1,p2,p3);
+
+	v1.mNormal[0] = n[0];
+	v1.mNormal[1] = n[1];
+	v1.mNormal[2] = n[2];
+
+	v2.mNormal[0] = n[0];
+	v2.mNormal[1] = n[1];
+	v2.mNormal[2] = n[2];
+
+	v3.mNormal[0] = n[0];
+	v3.mNormal[1] = n[1];
+	v3.mNormal[2] = n[2];
+
+	const Real *tp1 = p1;
+	const Real *tp2 = p2;
+	const Real *tp3 = p3;
+
+	int i1 = 0;
+	int i2 = 0;
+
+	Real nx = fabs(n[0]);
+	Real ny = fabs(n[1]);
+	Real nz = fabs(n[2]);
+
+	if ( nx <= ny && nx <= nz ) 
+		i1 = 0;
+	if ( ny <= nx && ny <= nz ) 
+		i1 = 1;
+	if ( nz <= nx && nz <= ny ) 
+		i1 = 2;
+
+	switch ( i1 )
+	{
+		case 0:
+			if ( ny < nz )
+				i2 = 1;
+			else
+				i2 = 2;
+			break;
+		case 1:
+			if ( nx < nz )
+				i2 = 0;
+			else
+				i2 = 2;
+			break;
+		case 2:
+			if ( nx < ny )
+				i2 = 0;
+			else
+				i2 = 1;
+			break;
+	}
+
+	v1.mTexel[0] = tp1[i1]*TSCALE1;
+	v1.mTexel[1] = tp1[i2]*TSCALE1;
+
+	v2.mTexel[0] = tp2[i1]*TSCALE1;
+	v2.mTexel[1] = tp2[i2]*TSCALE1;
+
+	v3.mTexel[0] = tp3[i1]*TSCALE1;
+	v3.mTexel[1] = tp3[i2]*TSCALE1;
+
+	callback->ConvexHullTriangle(v3,v2,v1);
+}
+
+//==================================================================================
+static Real ComputeNormal(Real *n,const Real *A,const Real *B,const Real *C)
+{
+	Real vx,vy,vz,wx,wy,wz,vw_x,vw_y,vw_z,mag;
+
+	vx = (B[0] - C[0]);
+	vy = (B[1] - C[1]);
+	vz = (B[2] - C[2]);
+
+	wx = (A[0] - B[0]);
+	wy = (A[1] - B[1]);
+	wz = (A[2] - B[2]);
+
+	vw_x = vy * wz - vz * wy;
+	vw_y = vz * wx - vx * wz;
+	vw_z = vx * wy - vy * wx;
+
+	mag = sqrt((vw_x * vw_x) + (vw_y * vw_y) + (vw_z * vw_z));
+
+	if ( mag < 0.000001f )
+	{
+		mag = 0;
+	}
+	else
+	{
+		mag = 1.0f/mag;
+	}
+
+	n[0] = vw_x * mag;
+	n[1] = vw_y * mag;
+	n[2] = vw_z * mag;
+
+	return mag;
+}
+
+
+//*****************************************************
+//*** Incremental hull (IncrementalHullT)
+//*****************************************************
+// Keeps the triangles, their adjacency and the hull vertices alive between calls.
+// Each batch is handed out to the faces it is outside of with the conflict lists,
+// and only the faces those points can see get extruded.  Afterwards the vertex and
+// triangle tables are packed down to the hull itself, so the cost of a batch does
+// not grow with the number of points seen before it.  Until the points span a volume
+// they are only collected: each batch is checked against the points that span a point,
+// a line and a plane so far, and once one is further than epsilon off that plane it is
+// fitted again through the extremes of every point and the hull is built if they really
+// are that thick.  A cloud that is flat but for rounding would otherwise give a sliver
+// that lets go of every point in the plane it does not happen to keep.
+
+class IncrementalState
+{
+public:
+	IncrementalState(void)
+	{
+		hc.conflictlists = true;
+		built = false;
+		span  = 0;
+		retry = 0;
+	}
+
+	~IncrementalState(void)
+	{
+		releasetris(hc);
+	}
+
+	HullContext  hc;
+	Array<real3> verts;      // the hull vertices, followed by the batch being added
+	HullBits     isextreme;
+	real3        bmin;
+	real3        bmax;
+	bool         built;      // false until the points seen so far span a volume
+	int          span;       // until then: witness holds a point, a line, a plane (1..3), 4 once one is off it
+	real3        witness[3];
+	int          retry;      // how many points a span of 4 the fit turned down waits for before it is fitted again
+};
+
+// Widens the span of the points collected so far by v, anything within epsilon of it
+// leaves it as it is, see IncrementalState.
+static void widenspan(IncrementalState &is,const real3 &v,Real epsilon)
+{
+	real3 *w = is.witness;
+	switch ( is.span )
+	{
+		case 0:
+			w[0] = v;
+			is.span = 1;
+			break;
+		case 1:
+			if ( magnitude(v-w[0]) > epsilon ) { w[1] = v; is.span = 2; }
+			break;
+		case 2:
+			if ( magnitude(cross(normalize(w[1]-w[0]),v-w[0])) > epsilon ) { w[2] = v; is.span = 3; }
+			break;
+		case 3:
+			if ( fabs(dot(normalize(cross(w[1]-w[0],w[2]-w[0])),v-w[0])) > epsilon ) is.span = 4;
+			break;
+	}
+}
+
+// Fits the span through the extremes of every point collected, like PlanarPrism: both
+// ends of the widest axis and the point furthest off the line through them.  Returns
+// true when some point is more than epsilon off that plane.
+static bool fitspan(IncrementalState &is,Real epsilon)
+{
+	const real3 *verts = is.verts.element;
+	int count = is.verts.count;
+	real3 extent = is.bmax-is.bmin;
+	int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z) ? 1 : 2;
+	int i0 = 0, i1 = 0;
+	for (int i=1; i<count; i++)
+	{
+		if ( verts[i][axis] < verts[i0][axis] ) i0 = i;
+		if ( verts[i][axis] > verts[i1][axis] ) i1 = i;
+	}
+	real3 *w = is.witness;
+	w[0] = verts[i0];
+	w[1] = verts[i1];
+	is.span = 1;
+	if ( magnitude(w[1]-w[0]) <= epsilon ) return false;
+	is.span = 2;
+	real3 u = normalize(w[1]-w[0]);
+	Real best = -1;
+	for (int i=0; i<count; i++)
+	{
+		Real d = magnitude(cross(u,verts[i]-w[0]));
+		if ( d > best ) { best = d; w[2] = verts[i]; }
+	}
+	if ( best <= epsilon ) return false;
+	is.span = 3;
+	real3 n = normalize(cross(w[1]-w[0],w[2]-w[0]));
+	for (int i=0; i<count; i++)
+	{
+		if ( fabs(dot(n,verts[i]-w[0])) > epsilon ) { is.span = 4; return true; }
+	}
+	return false;
+}
+
+// Renumbers the live triangles and the vertices they use down to 0..n-1.
+static void packincremental(IncrementalState &is)
+{
+	HullContext &hc   = is.hc;
+	Array<Tri*> &tris = hc.tris;
+	Array<int> vmap(is.verts.count);
+	Array<int> tmap(tris.count);
+	int i,j;
+	for(i=0;i<is.verts.count;i++) vmap.Add(-1);
+	int live=0;
+	for(i=0;i<tris.count;i++)
+	{
+		tmap.Add(tris[i] ? live++ : -1);
+		if(!tris[i]) continue;
+		for(j=0;j<3;j++) vmap[(*tris[i])[j]] = 0;
+	}
+	int vcount=0;
+	for(i=0;i<is.verts.count;i++)
+	{
+		if(vmap[i]<0) continue;
+		vmap[i] = vcount;
+		is.verts[vcount] = is.verts[i];
+		vcount++;
+	}
+	is.verts.count = vcount;
+	is.isextreme.Clear();
+	is.isextreme.Resize(vcount);
+	for(i=0;i<vcount;i++) is.isextreme.Set(i);
+	live=0;
+	for(i=0;i<tris.count;i++)
+	{
+		Tri *t = tris[i];
+		if(!t) continue;
+		for(j=0;j<3;j++)
+		{
+			(*t)[j] = vmap[(*t)[j]];
+			t->n[j] = tmap[t->n[j]];
+		}
+		t->id        = live;
+		t->vmax      = -1;
+		t->conflicts = -1;
+		t->visit     = -1;  // these hold vertex numbers, which have just changed
+		tris[live++] = t;
+	}
+	tris.count = live;
+	hc.riseheap.count = 0;
+	hc.orphans.count  = 0;
+}
+
+static HullError AddPoints(IncrementalState &is,const HullDesc &batch)
+{
+	if ( batch.mVcount == 0 ) return QE_OK;
+
+	HullVertexReader src(batch);
+	int first = is.verts.count;
+	for (unsigned int i=0; i<batch.mVcount; i++)
+	{
+		Real p[3];
+		src.Get(i,p);
+		real3 v(p[0],p[1],p[2]);
+		if ( first == 0 && i == 0 ) is.bmin = is.bmax = v;
+		is.bmin = VectorMin(is.bmin,v);
+		is.bmax = VectorMax(is.bmax,v);
+		is.verts.Add(v);
+	}
+	is.isextreme.Resize(is.verts.count);
+
+	HullContext &hc = is.hc;
+	if ( !is.built )
+	{
+		// no hull until the points are thicker than the epsilon the build works to
+		Real epsilon = magnitude(is.bmax-is.bmin) * 0.001f;
+		for (int i=first; i<is.verts.count && is.span<4; i++) widenspan(is,is.verts[i],epsilon);
+		if ( is.span < 4 || is.verts.count < is.retry ) return QE_OK;
+		if ( !fitspan(is,epsilon) || !calchullgen(hc,is.verts.element,is.verts.count,0) )
+		{
+			releasetris(hc);
+			is.span  = 4;                  // checked again, with all the points there are by then,
+			is.retry = is.verts.count*2;   // once there are twice as many so that the fits cost no more than the points
+			return QE_OK;
+		}
+		is.built = true;
+	}
+	else
+	{
+		Real epsilon = magnitude(is.bmax-is.bmin) * 0.001f;
+		Array<int> &next = hc.conflictnext;
+		next.count = 0;
+		next.SetSize(is.verts.count);
+		int head=-1;
+		for(int j=is.verts.count-1;j>=first;j--)
+		{
+			next[j]=head;
+			head=j;
+		}
+		hc.orphans.count=0;
+		hc.orphans.Add(head);
+		assignconflicts(hc,is.verts.element,0,epsilon,is.isextreme);
+		Array<int> allow; // only looked at without conflict lists
+		expandhull(hc,is.verts.element,is.verts.count,1000000000,epsilon,is.isextreme,allow);
+	}
+	packincremental(is);
+	return QE_OK;
+}
+
+static HullError GetResult(IncrementalState &is,unsigned int flags,HullResultT<Real> &result)
+{
+	if ( !is.built )
+	{
+		// points that are not (yet) known to span a volume are hulled like CreateConvexHull does, flat ones as a slab
+		if ( is.verts.count == 0 ) return QE_FAIL;
+		HullDesc desc;
+		desc.mFlags         = flags;
+		desc.mVcount        = is.verts.count;
+		desc.mNormalEpsilon = 0;
+		desc.mMaxVertices   = 0;
+		desc.SetComponents(&is.verts[0].x,&is.verts[0].y,&is.verts[0].z,sizeof(real3));
+		return CreateConvexHull(desc,result);
+	}
+
+	Array<int> ts;
+	for(int i=0;i<is.hc.tris.count;i++)
+	{
+		Tri *t = is.hc.tris[i];
+		for(int j=0;j<3;j++) ts.Add((*t)[j]);
+	}
+
+	PHullResult hr;
+	hr.mVcount     = is.verts.count;
+	hr.mVertices   = (Real *) is.verts.element;
+	hr.mIndexCount = ts.count;
+	hr.mFaceCount  = ts.count/3;
+	hr.mIndices    = (unsigned int *) ts.element;
+
+	unsigned int ovcount;
+	Array<unsigned int> used;
+	Real *vscratch = (Real *) NX_ALLOC( sizeof(Real)*hr.mVcount*3, CONVEX_TEMP );
+	BringOutYourDead(hr.mVertices,hr.mVcount, vscratch, ovcount, hr.mIndices, hr.mIndexCount, NULL, used );
+	CopyResult(flags,hr,vscratch,ovcount,result,NULL);
+	NX_FREE(vscratch);
+	return QE_OK;
+}
+
+} // namespace HULL_NAMESPACE
+
+#undef VOLUME_EPSILON
+#undef SMALLHULL_LANES
+
+template<> HullError HullLibraryT<HULL_REAL>::CreateConvexHull(const HullDesc &desc,HullResultT<HULL_REAL> &result)
+{
+	return HULL_NAMESPACE::CreateConvexHull(desc,result);
+}
+
+template<> HullError HullLibraryT<HULL_REAL>::CreateConvexHullLODs(const HullDesc &desc,const unsigned int *budgets,unsigned int count,HullResultT<HULL_REAL> *results)
+{
+	return HULL_NAMESPACE::CreateConvexHullLODs(desc,budgets,count,results);
+}
+
+template<> HullError HullLibraryT<HULL_REAL>::CreateConvexHulls(const HullDesc *descs,unsigned int count,HullResultT<HULL_REAL> *results,HullError *errors)
+{
+	return HULL_NAMESPACE::CreateConvexHulls(descs,count,results,errors);
+}
+
+template<> HullError HullLibraryT<HULL_REAL>::CreateConvexHullAsync(const HullDesc &desc,HullFutureT<HULL_REAL> &future,HullPriority priority,HullFutureT<HULL_REAL>::Callback callback,void *user)
+{
+	return HULL_NAMESPACE::CreateConvexHullAsync(desc,future,*(HULL_NAMESPACE::AsyncState *) future.mState,priority,callback,user);
+}
+
+template<> HullError HullLibraryT<HULL_REAL>::ReleaseResult(HullResultT<HULL_REAL> &result)
+{
+	return HULL_NAMESPACE::ReleaseResult(result);
+}
+
+template<> HullError HullLibraryT<HULL_REAL>::CreateTriangleMesh(HullResultT<HULL_REAL> &answer,ConvexHullTriangleInterface *iface)
+{
+	return HULL_NAMESPACE::CreateTriangleMesh(answer,iface);
+}
+
+template<> IncrementalHullT<HULL_REAL>::IncrementalHullT(void)
+{
+	mState = new HULL_NAMESPACE::IncrementalState;
+}
+
+template<> IncrementalHullT<HULL_REAL>::~IncrementalHullT(void)
+{
+	delete (HULL_NAMESPACE::IncrementalState *) mState;
+}
+
+template<> HullError IncrementalHullT<HULL_REAL>::AddPoints(const HullDesc &batch)
+{
+	return HULL_NAMESPACE::AddPoints(*(HULL_NAMESPACE::IncrementalState *) mState,batch);
+}
+
+template<> HullError IncrementalHullT<HULL_REAL>::GetResult(HullResultT<HULL_REAL> &result,unsigned int flags)
+{
+	return HULL_NAMESPACE::GetResult(*(HULL_NAMESPACE::IncrementalState *) mState,flags,result);
+}
+
+template<> HullError IncrementalHullT<HULL_REAL>::ReleaseResult(HullResultT<HULL_REAL> &result)
+{
+	return HULL_NAMESPACE::ReleaseResult(result);
+}
+
+template<> void IncrementalHullT<HULL_REAL>::Reset(void)
+{
+	delete (HULL_NAMESPACE::IncrementalState *) mState;
+	mState = new HULL_NAMESPACE::IncrementalState;
+}
+
+template<> HullWorkspaceT<HULL_REAL>::HullWorkspaceT(void)
+{
+	HULL_NAMESPACE::HullScratch *scratch = new HULL_NAMESPACE::HullScratch;
+	scratch->ownresults = true;
+	mState = scratch;
+}
+
+template<> HullWorkspaceT<HULL_REAL>::~HullWorkspaceT(void)
+{
+	delete (HULL_NAMESPACE::HullScratch *) mState;
+}
+
+template<> HullError HullWorkspaceT<HULL_REAL>::CreateConvexHull(const HullDesc &desc,HullResultT<HULL_REAL> &result)
+{
+	return HULL_NAMESPACE::BuildConvexHull(*(HULL_NAMESPACE::HullScratch *) mState,desc,NULL,0,&result);
+}
+
+template<> HullFutureT<HULL_REAL>::HullFutureT(void)
+{
+	mState = new HULL_NAMESPACE::AsyncState;
+}
+
+template<> HullFutureT<HULL_REAL>::~HullFutureT(void)
+{
+	HULL_NAMESPACE::AsyncState *s = (HULL_NAMESPACE::AsyncState *) mState;
+	HULL_NAMESPACE::CancelAsync(*s);
+	HULL_NAMESPACE::waitasync(*s,HULL_NAMESPACE::ASYNC_DONE);
+	HULL_NAMESPACE::ReleaseResult(s->result); // the future owns it, a no-op if the caller already released it
+	delete s;
+}
+
+template<> bool HullFutureT<HULL_REAL>::IsReady(void) const
+{
+	HULL_NAMESPACE::AsyncState *s = (HULL_NAMESPACE::AsyncState *) mState;
+#if HULL_THREADS
+	std::lock_guard<std::mutex> lock(s->lock);
+#endif
+	return s->stage == HULL_NAMESPACE::ASYNC_IDLE || s->stage >= HULL_NAMESPACE::ASYNC_READY;
+}
+
+template<> HullError HullFutureT<HULL_REAL>::Wait(void)
+{
+	HULL_NAMESPACE::AsyncState *s = (HULL_NAMESPACE::AsyncState *) mState;
+	return HULL_NAMESPACE::waitasync(*s,HULL_NAMESPACE::ASYNC_READY) ? s->error : QE_FAIL;
+}
+
+template<> HullResultT<HULL_REAL> & HullFutureT<HULL_REAL>::GetResult(void)
+{
+	return ((HULL_NAMESPACE::AsyncState *) mState)->result;
+}
+
+template<> void HullFutureT<HULL_REAL>::Cancel(void)
+{
+	HULL_NAMESPACE::CancelAsync(*(HULL_NAMESPACE::AsyncState *) mState);
+}
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <chrono>
 
 #include "wavefront.h"
 #include "hull.h"
@@ -13,6 +14,55 @@
     #define stricmp  strcasecmp
 #endif
 
+// n points scattered through the unit ball in no particular order, x,y,z each.
+static float * randomBall(int n)
+{
+	float *p = (float *) malloc(sizeof(float)*3*n);
+	srand(1);
+	for (int i=0; i<n; i++)
+	{
+		float x,y,z;
+		do
+		{
+			x = (float) rand()/RAND_MAX*2-1;
+			y = (float) rand()/RAND_MAX*2-1;
+			z = (float) rand()/RAND_MAX*2-1;
+		} while ( x*x+y*y+z*z > 1 );
+		p[i*3+0] = x;
+		p[i*3+1] = y;
+		p[i*3+2] = z;
+	}
+	return p;
+}
+
+// Average milliseconds per hull over count builds of desc.
+template <class Real> static double timeHull(const HullDesc &desc,int count)
+{
+	HullLibraryT<Real> hl;
+	double total = 0;
+	for (int i=0; i<count; i++)
+	{
+		HullResultT<Real> result;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		hl.CreateConvexHull(desc,result);
+		total += std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+		hl.ReleaseResult(result);
+	}
+	return total/count;
+}
+
+// Times the hull with the points in input order and sorted along a Morton curve.
+static void benchmark(const HullDesc &desc,int count,bool singleprecision)
+{
+	HullDesc d = desc;
+	for (int k=0; k<2; k++)
+	{
+		if ( k ) d.SetHullFlag(QF_SPATIAL_ORDER); else d.ClearHullFlag(QF_SPATIAL_ORDER);
+		double ms = singleprecision ? timeHull<float>(d,count) : timeHull<double>(d,count);
+		printf("%-13s %10.3f ms per hull (%d runs)\r\n", k ? "Morton order:" : "Input order:", ms, count );
+	}
+}
+
 int main(int argc,char **argv)
 {
 	if ( argc < 2 )
@@ -25,12 +75,29 @@ int main(int argc,char **argv)
 		printf("-s(n) skin width\r\n");
 		printf("-v(n) maximum number of vertices\r\n");
 		printf("-n(n) normal epsilon\r\n");
+		printf("-c  use per-face conflict lists (faster on large inputs).\r\n");
+		printf("-f  compute the hull in single precision.\r\n");
+		printf("-p  spread the work over every core.\r\n");
+		printf("-k  drop interior points with a k-DOP prefilter first.\r\n");
+		printf("-x  use exact orientation tests.\r\n");
+		printf("-e(n) stop once no point is further than this outside the hull\r\n");
+		printf("-w(n) thickness of the slab a flat input is turned into\r\n");
+		printf("-m  sort the points along a Morton curve first.\r\n");
+		printf("-l  keep memory low, for very large inputs.\r\n");
+		printf("-q  use the small input engine when there are few points.\r\n");
+		printf("-a  meet the -e tolerance by hulling a one pass coreset.\r\n");
+		printf("-d(n) stop after n seconds and keep the hull so far.\r\n");
+		printf("-g(n) hull n random points in a ball instead of the file's.\r\n");
+		printf("-b(n) time n builds in input order and n in Morton order first.\r\n");
 	}
 	else
 	{
 		char *fname = argv[1];
 
     HullDesc desc;
+    bool singleprecision = false;
+    int generate = 0;
+    int bench = 0;
 
     for (int i=2; i<argc; i++)
     {
@@ -59,40 +126,131 @@ int main(int argc,char **argv)
     		desc.mNormalEpsilon = (float) atof( &option[2] );
     		printf("Normal epsilon: %0.4f\r\n", desc.mNormalEpsilon );
     	}
+    	else if ( stricmp(option,"-c") == 0 )
+    	{
+    		desc.SetHullFlag(QF_CONFLICT_LISTS);
+    		printf("Using conflict lists.\r\n");
+    	}
+    	else if ( stricmp(option,"-f") == 0 )
+    	{
+    		singleprecision = true;
+    		printf("Using single precision.\r\n");
+    	}
+    	else if ( stricmp(option,"-p") == 0 )
+    	{
+    		desc.SetHullFlag(QF_PARALLEL);
+    		printf("Using all cores.\r\n");
+    	}
+    	else if ( stricmp(option,"-k") == 0 )
+    	{
+    		desc.SetHullFlag(QF_PREFILTER);
+    		printf("Using the k-DOP prefilter.\r\n");
+    	}
+    	else if ( stricmp(option,"-x") == 0 )
+    	{
+    		desc.SetHullFlag(QF_EXACT_PREDICATES);
+    		printf("Using exact orientation tests.\r\n");
+    	}
+    	else if ( strnicmp(option,"-e",2) == 0 )
+    	{
+    		desc.mTolerance = atof( &option[2] );
+    		printf("Tolerance: %0.4f\r\n", desc.mTolerance );
+    	}
+    	else if ( strnicmp(option,"-w",2) == 0 )
+    	{
+    		desc.mPlanarThickness = atof( &option[2] );
+    		printf("Planar thickness: %0.4f\r\n", desc.mPlanarThickness );
+    	}
+    	else if ( stricmp(option,"-m") == 0 )
+    	{
+    		desc.SetHullFlag(QF_SPATIAL_ORDER);
+    		printf("Using Morton order.\r\n");
+    	}
+    	else if ( stricmp(option,"-l") == 0 )
+    	{
+    		desc.SetHullFlag(QF_LOW_MEMORY);
+    		printf("Keeping memory low.\r\n");
+    	}
+    	else if ( stricmp(option,"-q") == 0 )
+    	{
+    		desc.SetHullFlag(QF_SMALL_INPUT);
+    		printf("Using the small input engine.\r\n");
+    	}
+    	else if ( stricmp(option,"-a") == 0 )
+    	{
+    		desc.SetHullFlag(QF_CORESET);
+    		printf("Using a coreset.\r\n");
+    	}
+    	else if ( strnicmp(option,"-d",2) == 0 )
+    	{
+    		desc.mTimeLimit = atof( &option[2] );
+    		printf("Time limit: %0.3f seconds\r\n", desc.mTimeLimit );
+    	}
+    	else if ( strnicmp(option,"-g",2) == 0 )
+    	{
+    		generate = atoi( &option[2] );
+    		printf("Random points: %d\r\n", generate );
+    	}
+    	else if ( strnicmp(option,"-b",2) == 0 )
+    	{
+    		bench = atoi( &option[2] );
+    		if ( bench < 1 ) bench = 1;
+    		printf("Benchmark runs: %d\r\n", bench );
+    	}
 
     }
 
 		WavefrontObj w;
+		float *generated = 0;
 
-    int t = w.loadObj( fname );
+    int t;
+    if ( generate > 0 )
+    {
+    	generated = randomBall(generate);
+    	desc.mVcount = generate;
+    	desc.SetVertices(generated, sizeof(float)*3);
+    	printf("Generated %d random points in a ball.\r\n", generate );
+    	t = 1;
+    }
+    else
+    {
+    	t = w.loadObj( fname );
+    	if ( t )
+    	{
+    		desc.mVcount       = w.mVertexCount;
+    		desc.SetVertices(w.mVertices, sizeof(float)*3); // read the obj's floats in place
+    		printf("Read Wavefront OBJ %s with %d vertices and %d triangles.\r\n", fname, w.mVertexCount, w.mTriCount );
+    	}
+    }
     if ( t )
     {
+      if ( bench ) benchmark(desc,bench,singleprecision);
 
-    	desc.mVcount       = w.mVertexCount;
-			desc.mVertices     = new double[desc.mVcount*3];
-
-			for (unsigned int i=0; i<desc.mVcount; i++)
-			{
-				desc.mVertices[i*3+0] = w.mVertices[i*3+0];
-				desc.mVertices[i*3+1] = w.mVertices[i*3+1];
-				desc.mVertices[i*3+2] = w.mVertices[i*3+2];
-			}
-
-    	desc.mVertexStride = sizeof(double)*3;
-
-      printf("Read Wavefront OBJ %s with %d vertices and %d triangles.\r\n", fname, w.mVertexCount, w.mTriCount );
       printf("Now generating a convex hull.\r\n");
 
       HullResult dresult;
       HullLibrary hl;
+      HullResultF fresult;
+      HullLibraryF hlf;
 
-      HullError ret = hl.CreateConvexHull(desc,dresult);
+      HullError ret = singleprecision ? hlf.CreateConvexHull(desc,fresult) : hl.CreateConvexHull(desc,dresult);
 
       if ( ret == QE_OK )
       {
-				FHullResult result(dresult); // convert it from doubles back into floats.
+				FHullResult *presult = singleprecision ? new FHullResult(fresult) : new FHullResult(dresult); // convert it from doubles back into floats.
+				FHullResult &result  = *presult;
 
       	printf("Successfully created convex hull.\r\n");
+      	printf("Working set: %0.1f MB\r\n", result.mWorkingSet/(1024.0*1024.0) );
+
+        if ( desc.HasHullFlag(QF_PREFILTER) )
+        	printf("Prefilter discarded %0.1f%% of the points.\r\n", result.mPrefilterRatio*100 );
+
+        if ( result.mTruncated )
+        	printf("Out of time, the hull is unfinished.\r\n");
+
+        if ( desc.mTolerance > 0 || result.mTruncated )
+        	printf("Furthest point outside the hull: %0.6f\r\n", result.mHullError );
 
         if ( result.mPolygons )
         	printf("Hull contains %d poygons.\r\n", result.mNumFaces );
@@ -140,14 +298,17 @@ int main(int argc,char **argv)
   				fclose(fph);
   			}
 
-				delete desc.mVertices;
+				delete presult;
       	hl.ReleaseResult(dresult);
+      	hlf.ReleaseResult(fresult);
       }
       else
       {
       	printf("Failed to create convex hull.\r\n");
+      	free(generated);
         return 1;
       }
+      free(generated);
 
     }
     else